@@ -0,0 +1,270 @@
+// ****************************************************
+// * Code by Kidsadakorn Nuallaoong
+// * Neural Network - Activation
+// * Activation functions resolved once per neuron/layer
+// ****************************************************
+
+#if !defined(ACTIVATION_H)
+#define ACTIVATION_H
+
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+// * Activation identifiers, the numeric values are stable (used by model files)
+enum ActivationType {
+    LINEAR = 0,
+    SIGMOID = 1,
+    TANH = 2,
+    RELU = 3,
+    LEAKYRELU = 4,
+    SOFTMAX = 5,
+    STEP = 6
+};
+
+/**
+ * @brief Implementation of sigmoid and tanh, an accuracy / speed trade-off chosen per model.
+ *
+ * Max absolute error against std::exp / std::tanh over the whole real line, measured
+ * by Tools/bench (activation_accuracy) for float and double, scalar and vectorized:
+ * - PRECISION_EXACT: std::exp / std::tanh (the vectorized kernels use a polynomial exp, about 1 ulp).
+ * - PRECISION_RATIONAL: rational tanh (TanhRational), 4e-7 for tanh, 2e-7 for sigmoid.
+ * - PRECISION_TABLE: tanh table with linear interpolation (TanhTable), 6e-6 for tanh, 3e-6 for sigmoid.
+ *
+ * The numeric values are stable (used by model files). Other activations are exact in every mode.
+ */
+enum ActivationPrecision {
+    PRECISION_EXACT = 0,
+    PRECISION_RATIONAL = 1,
+    PRECISION_TABLE = 2
+};
+
+/**
+ * @brief Rational approximation tanh(x) ~ x * P(x^2) / Q(x^2), clamped to |x| <= CLAMP.
+ *
+ * Degree 13 / 6, the coefficients are shared by the scalar and the vectorized kernels
+ * (Horner order, highest degree first).
+ */
+struct TanhRational
+{
+    static constexpr float CLAMP = 7.90531110763549805f;
+    static constexpr float P[7] = {
+        -2.76076847742355e-16f, 2.00018790482477e-13f, -8.60467152213735e-11f, 5.12229709037114e-08f,
+        1.48572235717979e-05f, 6.37261928875436e-04f, 4.89352455891786e-03f
+    };
+    static constexpr float Q[4] = {
+        1.19825839466702e-06f, 1.18534705686654e-04f, 2.26843463243900e-03f, 4.89352518554385e-03f
+    };
+
+    template <typename T>
+    static T eval(T x)
+    {
+        x = std::min(std::max(x, T(-CLAMP)), T(CLAMP));
+        T x2 = x * x;
+        T p = T(P[0]);
+        for (int k = 1; k < 7; ++k) {
+            p = p * x2 + T(P[k]);
+        }
+        T q = T(Q[0]);
+        for (int k = 1; k < 4; ++k) {
+            q = q * x2 + T(Q[k]);
+        }
+        return x * p / q;
+    }
+};
+
+/**
+ * @brief tanh sampled on [0, RANGE] in SIZE intervals, evaluated by linear interpolation.
+ *
+ * tanh is odd, so only the positive half is stored; beyond RANGE the last entry is used
+ * (tanh(8) = 1 - 2.3e-7). 4 KB, built once on first use.
+ */
+struct TanhTable
+{
+    static const int SIZE = 1024;
+    static constexpr float RANGE = 8.0f;
+    static constexpr float SCALE = SIZE / RANGE; // * table steps per unit of x
+
+    // * one extra entry so that interpolating from the last sample stays in bounds
+    float values[SIZE + 2];
+
+    static const TanhTable& get()
+    {
+        static const TanhTable table;
+        return table;
+    }
+
+    template <typename T>
+    T eval(T x) const
+    {
+        T t = std::fabs(x) * T(SCALE);
+        if (!(t < T(SIZE))) {
+            t = T(SIZE); // * also catches nan, so the index stays in bounds
+        }
+        int i = (int)t;
+        T f = t - T(i);
+        T y = T(values[i]) + f * (T(values[i + 1]) - T(values[i]));
+        return std::copysign(y, x);
+    }
+
+    private:
+        TanhTable()
+        {
+            for (int i = 0; i <= SIZE; ++i) {
+                values[i] = (float)std::tanh(i / (double)SCALE);
+            }
+            values[SIZE + 1] = values[SIZE];
+        }
+};
+
+/**
+ * @brief Scalar activation functions for a given value type.
+ *
+ * Each activation is a plain static function so that a neuron can resolve its
+ * activation once (see resolve) and call it through a pointer on the hot path
+ * instead of comparing strings per evaluation.
+ *
+ * @tparam T The data type (e.g., float, double).
+ */
+template <typename T>
+struct Activation
+{
+    typedef T (*Function)(T);
+
+    static T linear(T x) { return x; }
+    static T sigmoid(T x) { return T(1) / (T(1) + exp(-x)); }
+    static T tanh(T x) { return std::tanh(x); }
+    static T relu(T x) { return (x > 0) ? x : T(0); }
+    static T leakyrelu(T x) { return (x > 0) ? x : T(0.01) * x; }
+    static T step(T x) { return (x > 0) ? T(1) : T(0); }
+
+    // * approximations, see ActivationPrecision; sigmoid(x) = 0.5 + 0.5 * tanh(x / 2)
+    static T tanhRational(T x) { return TanhRational::eval(x); }
+    static T sigmoidRational(T x) { return T(0.5) + T(0.5) * TanhRational::eval(T(0.5) * x); }
+    static T tanhTable(T x) { return TanhTable::get().eval(x); }
+    static T sigmoidTable(T x) { return T(0.5) + T(0.5) * TanhTable::get().eval(T(0.5) * x); }
+    static T softmax(T)
+    {
+        // Softmax is not applicable here for scalar values.
+        std::cerr << "\033[1;31mSoftmax must be computed over a vector, not a scalar.\033[0m" << std::endl;
+        throw std::invalid_argument("Softmax must be computed over a vector.");
+    }
+
+    /**
+     * @brief Returns the scalar function implementing the given activation.
+     */
+    static Function resolve(ActivationType type)
+    {
+        switch (type) {
+            case LINEAR:    return &Activation<T>::linear;
+            case SIGMOID:   return &Activation<T>::sigmoid;
+            case TANH:      return &Activation<T>::tanh;
+            case RELU:      return &Activation<T>::relu;
+            case LEAKYRELU: return &Activation<T>::leakyrelu;
+            case SOFTMAX:   return &Activation<T>::softmax;
+            case STEP:      return &Activation<T>::step;
+        }
+        std::cerr << "\033[1;31mActivation Type Not Found\033[0m" << std::endl;
+        throw std::invalid_argument("Activation Type Not Found");
+    }
+
+    /**
+     * @brief Returns the scalar function implementing the given activation at the given precision.
+     */
+    static Function resolve(ActivationType type, ActivationPrecision precision)
+    {
+        if (precision == PRECISION_RATIONAL) {
+            if (type == SIGMOID) return &Activation<T>::sigmoidRational;
+            if (type == TANH)    return &Activation<T>::tanhRational;
+        } else if (precision == PRECISION_TABLE) {
+            if (type == SIGMOID) return &Activation<T>::sigmoidTable;
+            if (type == TANH)    return &Activation<T>::tanhTable;
+        }
+        return resolve(type);
+    }
+};
+
+/**
+ * @brief Maps an activation name (case-insensitive) to its ActivationType.
+ *
+ * @param type The activation name (e.g., "linear", "sigmoid", "tanh", "relu", "leakyrelu", "softmax", "step").
+ * @param out Receives the parsed activation when the name is known.
+ * @return true if the name is known, false otherwise.
+ */
+inline bool parseActivation(string type, ActivationType& out)
+{
+    // * change type to lower case
+    for (size_t i = 0; i < type.length(); i++)
+    {
+        type[i] = tolower(type[i]);
+    }
+
+    if (type == "linear")         out = LINEAR;
+    else if (type == "sigmoid")   out = SIGMOID;
+    else if (type == "tanh")      out = TANH;
+    else if (type == "relu")      out = RELU;
+    else if (type == "leakyrelu") out = LEAKYRELU;
+    else if (type == "softmax")   out = SOFTMAX;
+    else if (type == "step")      out = STEP;
+    else return false;
+
+    return true;
+}
+
+/**
+ * @brief Returns the lower-case name of an activation.
+ */
+inline const char* activationName(ActivationType type)
+{
+    switch (type) {
+        case LINEAR:    return "linear";
+        case SIGMOID:   return "sigmoid";
+        case TANH:      return "tanh";
+        case RELU:      return "relu";
+        case LEAKYRELU: return "leakyrelu";
+        case SOFTMAX:   return "softmax";
+        case STEP:      return "step";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Maps a precision name (case-insensitive) to its ActivationPrecision.
+ *
+ * @param name "exact", "rational" or "table".
+ * @param out Receives the parsed precision when the name is known.
+ * @return true if the name is known, false otherwise.
+ */
+inline bool parseActivationPrecision(string name, ActivationPrecision& out)
+{
+    for (size_t i = 0; i < name.length(); i++)
+    {
+        name[i] = tolower(name[i]);
+    }
+
+    if (name == "exact")         out = PRECISION_EXACT;
+    else if (name == "rational") out = PRECISION_RATIONAL;
+    else if (name == "table")    out = PRECISION_TABLE;
+    else return false;
+
+    return true;
+}
+
+/**
+ * @brief Returns the lower-case name of a precision.
+ */
+inline const char* activationPrecisionName(ActivationPrecision precision)
+{
+    switch (precision) {
+        case PRECISION_EXACT:    return "exact";
+        case PRECISION_RATIONAL: return "rational";
+        case PRECISION_TABLE:    return "table";
+    }
+    return "unknown";
+}
+
+#endif // ACTIVATION_H
@@ -0,0 +1,702 @@
+/**
+ * @file Dense.cpp
+ * @brief Implementation of the DenseLayer and DenseNetwork classes.
+ * 
+ * A DenseLayer keeps every neuron of a layer in one contiguous row-major weight matrix
+ * and evaluates the layer as a single matrix-vector product. DenseNetwork chains layers
+ * and loads the model.json format produced by MultiLayerPerceptron.
+ * 
+ * @tparam T The data type for the weights, inputs, and outputs (e.g., float, double).
+ */
+
+#include "Dense.hpp"
+#include "../Kernels/Kernels.hpp"
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <stdexcept>
+#include <type_traits>
+#include <nlohmann/json.hpp>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+using namespace std;
+using std::vector;
+
+/**
+ * @brief Default constructor for the DenseLayer class.
+ */
+template <typename T>
+DenseLayer<T>::DenseLayer()
+{
+    typeActivation(SIGMOID);
+}
+
+/**
+ * @brief Constructor for the DenseLayer class with a specified shape.
+ * 
+ * @param inputSize The number of inputs to every neuron.
+ * @param outputSize The number of neurons in the layer.
+ */
+template <typename T>
+DenseLayer<T>::DenseLayer(int inputSize, int outputSize)
+{
+    init(inputSize, outputSize);
+    typeActivation(SIGMOID);
+}
+
+/**
+ * @brief Builds a fused layer from a layer of Perceptron objects.
+ * 
+ * The activation of the first neuron is used for the whole layer.
+ * 
+ * @param neurons The neurons of the layer, all with the same number of weights.
+ */
+template <typename T>
+DenseLayer<T>::DenseLayer(const vector<Perceptron<T>>& neurons)
+{
+    init(neurons.empty() ? 0 : (int)neurons[0].weights.size(), (int)neurons.size());
+    for (size_t i = 0; i < neurons.size(); ++i) {
+        setNeuron((int)i, neurons[i].weights, neurons[i].bias);
+    }
+    typeActivation(neurons.empty() ? SIGMOID : neurons[0].getActivationKind());
+    activationPrecision = neurons.empty() ? PRECISION_EXACT : neurons[0].getActivationPrecision();
+}
+
+/**
+ * @brief Initializes the layer with random weights and biases.
+ * 
+ * @param inputSize The number of inputs to every neuron.
+ * @param outputSize The number of neurons in the layer.
+ */
+template <typename T>
+void DenseLayer<T>::init(int inputSize, int outputSize)
+{
+    this->inputSize = inputSize;
+    this->outputSize = outputSize;
+    weights.resize((size_t)inputSize * outputSize);
+    bias.resize(outputSize);
+    for (size_t i = 0; i < weights.size(); ++i) {
+        weights[i] = ((T)rand() / RAND_MAX) * 2 - 1; // Random values between -1 and 1
+    }
+    for (size_t i = 0; i < bias.size(); ++i) {
+        bias[i] = ((T)rand() / RAND_MAX) * 2 - 1;
+    }
+}
+
+/**
+ * @brief Sets the weights and bias of one neuron (one row of the weight matrix).
+ * 
+ * @param index The neuron index.
+ * @param weights The neuron weights, must have inputSize elements.
+ * @param bias The neuron bias.
+ */
+template <typename T>
+void DenseLayer<T>::setNeuron(const int index, const vector<T>& weights, const T bias)
+{
+    if (index < 0 || index >= outputSize || (int)weights.size() != inputSize) {
+        std::cerr << "\033[1;31mDense layer shape mismatch\033[0m" << std::endl;
+        throw std::invalid_argument("Dense layer shape mismatch");
+    }
+
+    if (weightsView != nullptr) {
+        // * detach from the mapped file before modifying
+        this->weights.assign(weightsView, weightsView + (size_t)inputSize * outputSize);
+        this->bias.assign(biasView, biasView + outputSize);
+        weightsView = nullptr;
+        biasView = nullptr;
+    }
+
+    std::copy(weights.begin(), weights.end(), this->weights.begin() + (size_t)index * inputSize);
+    this->bias[index] = bias;
+}
+
+/**
+ * @brief Sets the activation function type for the layer.
+ * 
+ * @param type The activation function type (e.g., "linear", "sigmoid", "tanh", "relu", "leakyrelu", "softmax", "step").
+ */
+template <typename T>
+void DenseLayer<T>::typeActivation(string type)
+{
+    ActivationType kind;
+    if (!parseActivation(type, kind))
+    {
+        cerr << "\033[1;31mActivation Type Not Found\033[0m" << endl;
+        return;
+    }
+
+    typeActivation(kind);
+}
+
+/**
+ * @brief Sets the activation function type for the layer.
+ * 
+ * @param type The activation function type.
+ */
+template <typename T>
+void DenseLayer<T>::typeActivation(ActivationType type)
+{
+    this->activationKind = type;
+}
+
+/**
+ * @brief Evaluates the layer: outputs = activation(weights * inputs + bias).
+ * 
+ * Both the dot products and the activation run on the SIMD kernels. Softmax is
+ * applied over the whole output vector since the layer sees every neuron.
+ * 
+ * @param inputs Pointer to inputSize values.
+ * @param outputs Pointer to outputSize values, must not alias inputs.
+ */
+template <typename T>
+void DenseLayer<T>::forward(const T* inputs, T* outputs) const
+{
+    const T* row = weightData();
+    const T* b = biasData();
+    for (int o = 0; o < outputSize; ++o, row += inputSize) {
+        outputs[o] = b[o] + Kernels<T>::dot(row, inputs, inputSize);
+    }
+
+    Kernels<T>::activate(activationKind, outputs, outputSize, activationPrecision);
+}
+
+/**
+ * @brief Evaluates the layer on a vector of inputs.
+ * 
+ * @param inputs A vector containing inputSize values.
+ * @return A vector containing outputSize values.
+ */
+template <typename T>
+vector<T> DenseLayer<T>::forward(const vector<T>& inputs) const
+{
+    if ((int)inputs.size() != inputSize) {
+        std::cerr << "\033[1;31mDense layer input size mismatch\033[0m" << std::endl;
+        throw std::invalid_argument("Dense layer input size mismatch");
+    }
+
+    vector<T> outputs(outputSize);
+    forward(inputs.data(), outputs.data());
+    return outputs;
+}
+
+/**
+ * @brief Evaluates the layer on a batch of samples as one matrix-matrix product.
+ * 
+ * outputs[count x outputSize] = activation(inputs[count x inputSize] * weights^T + bias).
+ * Samples are processed four at a time so every weight row is loaded once per four samples.
+ * 
+ * @param inputs Pointer to count rows of inputSize values.
+ * @param count The number of samples.
+ * @param outputs Pointer to count rows of outputSize values, must not alias inputs.
+ */
+template <typename T>
+void DenseLayer<T>::forwardBatch(const T* inputs, size_t count, T* outputs) const
+{
+    const T* b = biasData();
+    T partial[4];
+    size_t s = 0;
+    for (; s + 4 <= count; s += 4) {
+        const T* x = inputs + s * inputSize;
+        T* y = outputs + s * outputSize;
+        const T* row = weightData();
+        for (int o = 0; o < outputSize; ++o, row += inputSize) {
+            Kernels<T>::dot4(row, x, inputSize, inputSize, partial);
+            y[o] = b[o] + partial[0];
+            y[outputSize + o] = b[o] + partial[1];
+            y[2 * outputSize + o] = b[o] + partial[2];
+            y[3 * outputSize + o] = b[o] + partial[3];
+        }
+    }
+    for (; s < count; ++s) {
+        const T* x = inputs + s * inputSize;
+        T* y = outputs + s * outputSize;
+        const T* row = weightData();
+        for (int o = 0; o < outputSize; ++o, row += inputSize) {
+            y[o] = b[o] + Kernels<T>::dot(row, x, inputSize);
+        }
+    }
+
+    if (activationKind == SOFTMAX) {
+        for (s = 0; s < count; ++s) {
+            Kernels<T>::softmax(outputs + s * outputSize, outputSize);
+        }
+        return;
+    }
+    Kernels<T>::activate(activationKind, outputs, count * outputSize, activationPrecision);
+}
+
+/**
+ * @brief Returns the row-major weight matrix used by forward.
+ */
+template <typename T>
+const T* DenseLayer<T>::weightData() const
+{
+    return weightsView != nullptr ? weightsView : weights.data();
+}
+
+/**
+ * @brief Returns the bias vector used by forward.
+ */
+template <typename T>
+const T* DenseLayer<T>::biasData() const
+{
+    return biasView != nullptr ? biasView : bias.data();
+}
+
+/**
+ * @brief Displays the current state of the layer.
+ */
+template <typename T>
+void DenseLayer<T>::display()
+{
+    cout << "\033[1;32m-->> Dense Layer <<--\033[0m" << endl << endl;
+    cout << "\033[1;33mShape:\033[0m " << outputSize << " x " << inputSize << endl;
+    cout << "\033[1;33mActivation Type:\033[0m " << activationName(activationKind) << endl;
+    cout << "\033[1;33mActivation Precision:\033[0m " << activationPrecisionName(activationPrecision) << endl;
+}
+
+/**
+ * @brief Default constructor for the DenseNetwork class.
+ */
+template <typename T>
+DenseNetwork<T>::DenseNetwork()
+{
+}
+
+/**
+ * @brief Destructor for the DenseNetwork class.
+ */
+template <typename T>
+DenseNetwork<T>::~DenseNetwork()
+{
+    clearModel();
+}
+
+/**
+ * @brief Appends a layer to the network.
+ * 
+ * @param layer The layer, its inputSize must match the previous layer outputSize.
+ */
+template <typename T>
+void DenseNetwork<T>::addLayer(const DenseLayer<T>& layer)
+{
+    if (!layers.empty() && layers.back().outputSize != layer.inputSize) {
+        std::cerr << "\033[1;31mDense layer shape mismatch\033[0m" << std::endl;
+        throw std::invalid_argument("Dense layer shape mismatch");
+    }
+
+    layers.push_back(layer);
+    reserveScratch();
+}
+
+/**
+ * @brief Loads a model written by MultiLayerPerceptron::export_to_json.
+ * 
+ * @param filename The path of the model.json file.
+ */
+template <typename T>
+void DenseNetwork<T>::import_from_json(const string& filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "\033[1;31mUnable to open model file: " << filename << "\033[0m" << std::endl;
+        throw std::runtime_error("Unable to open model file: " + filename);
+    }
+
+    nlohmann::json model = nlohmann::json::parse(file);
+
+    ActivationPrecision precision = PRECISION_EXACT;
+    if (!parseActivationPrecision(model.value("activationPrecision", string("exact")), precision)) {
+        std::cerr << "\033[1;31mActivation Precision Not Found\033[0m" << std::endl;
+        throw std::invalid_argument("Activation Precision Not Found");
+    }
+
+    clearModel();
+    for (const auto& jsonLayer : model.at("layers")) {
+        const auto& nodes = jsonLayer.at("nodes");
+        int outputSize = (int)nodes.size();
+        int inputSize = outputSize == 0 ? 0 : (int)nodes[0].at("weights").size();
+
+        DenseLayer<T> layer;
+        layer.inputSize = inputSize;
+        layer.outputSize = outputSize;
+        layer.weights.resize((size_t)inputSize * outputSize);
+        layer.bias.resize(outputSize);
+        for (int o = 0; o < outputSize; ++o) {
+            layer.setNeuron(o, nodes[o].at("weights").get<vector<T>>(), nodes[o].at("bias").get<T>());
+        }
+        layer.typeActivation(jsonLayer.value("activation", string("sigmoid")));
+        layer.activationPrecision = precision;
+
+        addLayer(layer);
+    }
+}
+
+/**
+ * @brief Maps a binary model file and uses its weight blocks in place.
+ * 
+ * The file is validated (magic, version, shapes, offsets) but not parsed or copied: layers
+ * point straight into the mapping. When the file dtype differs from T the blocks are converted
+ * into owned buffers instead. On Windows the file is read into memory.
+ * 
+ * @param filename The path of the model.bin file (see export_to_binary).
+ */
+template <typename T>
+void DenseNetwork<T>::import_from_binary(const string& filename)
+{
+    auto fail = [&filename](const string& reason) {
+        std::cerr << "\033[1;31mInvalid model file " << filename << ": " << reason << "\033[0m" << std::endl;
+        throw std::runtime_error("Invalid model file " + filename + ": " + reason);
+    };
+
+#if defined(_WIN32)
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        fail("unable to open");
+    }
+    size_t size = (size_t)file.tellg();
+    shared_ptr<char> buffer(new char[size + MODEL_FILE_ALIGN], std::default_delete<char[]>());
+    char* base = buffer.get() + (MODEL_FILE_ALIGN - (uintptr_t)buffer.get() % MODEL_FILE_ALIGN) % MODEL_FILE_ALIGN;
+    file.seekg(0);
+    file.read(base, size);
+    shared_ptr<const void> region(buffer, base);
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fail("unable to open");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(ModelFileHeader)) {
+        close(fd);
+        fail("truncated header");
+    }
+    size_t size = (size_t)info.st_size;
+    void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        fail("mmap failed");
+    }
+    shared_ptr<const void> region(address, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+    const char* base = static_cast<const char*>(address);
+#endif
+
+    if (size < sizeof(ModelFileHeader)) {
+        fail("truncated header");
+    }
+    const ModelFileHeader* header = reinterpret_cast<const ModelFileHeader*>(base);
+    if (std::memcmp(header->magic, MODEL_FILE_MAGIC, sizeof(MODEL_FILE_MAGIC)) != 0) {
+        fail("bad magic");
+    }
+    if (header->version != MODEL_FILE_VERSION) {
+        fail("unsupported version " + std::to_string(header->version));
+    }
+    if (header->dtype != DTYPE_FLOAT32 && header->dtype != DTYPE_FLOAT64) {
+        fail("unsupported dtype " + std::to_string(header->dtype));
+    }
+    if (header->fileSize != size || sizeof(ModelFileHeader) + (uint64_t)header->layerCount * sizeof(ModelFileLayer) > size) {
+        fail("size mismatch");
+    }
+
+    const size_t elementSize = header->dtype == DTYPE_FLOAT32 ? sizeof(float) : sizeof(double);
+    const bool inPlace = elementSize == sizeof(T) && (header->dtype == DTYPE_FLOAT32) == std::is_same<T, float>::value;
+    const ModelFileLayer* table = reinterpret_cast<const ModelFileLayer*>(base + sizeof(ModelFileHeader));
+    // * true when count elements starting at offset lie inside the file, without overflowing
+    auto fits = [size, elementSize](uint64_t offset, uint64_t count) {
+        return offset <= size && count <= (size - offset) / elementSize;
+    };
+
+    clearModel();
+    for (uint32_t l = 0; l < header->layerCount; ++l) {
+        const ModelFileLayer& entry = table[l];
+        // * shapes up to INT_MAX keep weightCount below 2^62, the block checks divide instead of multiplying
+        const uint64_t weightCount = (uint64_t)entry.inputSize * entry.outputSize;
+        if (entry.inputSize > (uint32_t)INT_MAX || entry.outputSize > (uint32_t)INT_MAX ||
+            entry.activation > STEP || entry.precision > PRECISION_TABLE ||
+            entry.weightsOffset % MODEL_FILE_ALIGN != 0 || entry.biasOffset % MODEL_FILE_ALIGN != 0 ||
+            !fits(entry.weightsOffset, weightCount) || !fits(entry.biasOffset, entry.outputSize)) {
+            clearModel();
+            fail("bad layer " + std::to_string(l));
+        }
+
+        DenseLayer<T> layer;
+        layer.inputSize = (int)entry.inputSize;
+        layer.outputSize = (int)entry.outputSize;
+        layer.typeActivation((ActivationType)entry.activation);
+        layer.activationPrecision = (ActivationPrecision)entry.precision;
+        if (inPlace) {
+            layer.weightsView = reinterpret_cast<const T*>(base + entry.weightsOffset);
+            layer.biasView = reinterpret_cast<const T*>(base + entry.biasOffset);
+        } else if (header->dtype == DTYPE_FLOAT32) {
+            const float* w = reinterpret_cast<const float*>(base + entry.weightsOffset);
+            const float* b = reinterpret_cast<const float*>(base + entry.biasOffset);
+            layer.weights.assign(w, w + weightCount);
+            layer.bias.assign(b, b + entry.outputSize);
+        } else {
+            const double* w = reinterpret_cast<const double*>(base + entry.weightsOffset);
+            const double* b = reinterpret_cast<const double*>(base + entry.biasOffset);
+            layer.weights.assign(w, w + weightCount);
+            layer.bias.assign(b, b + entry.outputSize);
+        }
+
+        try {
+            addLayer(layer);
+        } catch (const std::invalid_argument&) {
+            clearModel();
+            fail("layer " + std::to_string(l) + " does not match the previous layer");
+        }
+    }
+
+    if (inPlace) {
+        mapping = region;
+    }
+}
+
+/**
+ * @brief Writes the network as a binary model file for import_from_binary.
+ * 
+ * @param filename The path of the model.bin file.
+ */
+template <typename T>
+void DenseNetwork<T>::export_to_binary(const string& filename) const
+{
+    auto align = [](uint64_t offset) {
+        return (offset + MODEL_FILE_ALIGN - 1) / MODEL_FILE_ALIGN * MODEL_FILE_ALIGN;
+    };
+
+    ModelFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MODEL_FILE_MAGIC, sizeof(MODEL_FILE_MAGIC));
+    header.version = MODEL_FILE_VERSION;
+    header.dtype = std::is_same<T, float>::value ? DTYPE_FLOAT32 : DTYPE_FLOAT64;
+    header.layerCount = (uint32_t)layers.size();
+
+    vector<ModelFileLayer> table(layers.size());
+    uint64_t offset = align(sizeof(ModelFileHeader) + layers.size() * sizeof(ModelFileLayer));
+    for (size_t l = 0; l < layers.size(); ++l) {
+        std::memset(&table[l], 0, sizeof(ModelFileLayer));
+        table[l].inputSize = (uint32_t)layers[l].inputSize;
+        table[l].outputSize = (uint32_t)layers[l].outputSize;
+        table[l].activation = (uint32_t)layers[l].activationKind;
+        table[l].precision = (uint32_t)layers[l].activationPrecision;
+        table[l].weightsOffset = offset;
+        offset = align(offset + (uint64_t)layers[l].inputSize * layers[l].outputSize * sizeof(T));
+        table[l].biasOffset = offset;
+        offset = align(offset + (uint64_t)layers[l].outputSize * sizeof(T));
+    }
+    header.fileSize = offset;
+
+    vector<char> image(offset, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    std::memcpy(image.data() + sizeof(header), table.data(), table.size() * sizeof(ModelFileLayer));
+    for (size_t l = 0; l < layers.size(); ++l) {
+        std::memcpy(image.data() + table[l].weightsOffset, layers[l].weightData(),
+                    (size_t)layers[l].inputSize * layers[l].outputSize * sizeof(T));
+        std::memcpy(image.data() + table[l].biasOffset, layers[l].biasData(), (size_t)layers[l].outputSize * sizeof(T));
+    }
+
+    // * write a temporary file then rename it, a running process may have the old file mapped
+    const string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open() || !file.write(image.data(), image.size())) {
+            std::cerr << "\033[1;31mUnable to write model file: " << filename << "\033[0m" << std::endl;
+            throw std::runtime_error("Unable to write model file: " + filename);
+        }
+    }
+#if defined(_WIN32)
+    std::remove(filename.c_str());
+#endif
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::cerr << "\033[1;31mUnable to write model file: " << filename << "\033[0m" << std::endl;
+        throw std::runtime_error("Unable to write model file: " + filename);
+    }
+}
+
+/**
+ * @brief Returns the number of inputs of the network.
+ */
+template <typename T>
+int DenseNetwork<T>::inputSize() const
+{
+    return layers.empty() ? 0 : layers.front().inputSize;
+}
+
+/**
+ * @brief Returns the number of outputs of the network.
+ */
+template <typename T>
+int DenseNetwork<T>::outputSize() const
+{
+    return layers.empty() ? 0 : layers.back().outputSize;
+}
+
+/**
+ * @brief Selects how every layer evaluates sigmoid and tanh.
+ *
+ * @param precision Exact, rational or table, see ActivationPrecision.
+ */
+template <typename T>
+void DenseNetwork<T>::setActivationPrecision(ActivationPrecision precision)
+{
+    for (auto& layer : layers) {
+        layer.activationPrecision = precision;
+    }
+}
+
+/**
+ * @brief Predicts one sample without allocating.
+ * 
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ */
+template <typename T>
+void DenseNetwork<T>::predict(const T* inputs, T* outputs)
+{
+    predict(inputs, outputs, scratch);
+}
+
+/**
+ * @brief Predicts one sample without modifying the network.
+ * 
+ * Reentrant: the hidden activations live in the caller's scratch, which only allocates
+ * the first time it is used with this network.
+ * 
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ * @param scratch Buffers owned by the calling thread.
+ */
+template <typename T>
+void DenseNetwork<T>::predict(const T* inputs, T* outputs, Scratch& scratch) const
+{
+    if (layers.empty()) {
+        return;
+    }
+    if (scratch.a.size() < widest) {
+        scratch.a.resize(widest);
+        scratch.b.resize(widest);
+    }
+
+    const T* current = inputs;
+    for (size_t l = 0; l + 1 < layers.size(); ++l) {
+        T* next = (l % 2 == 0) ? scratch.a.data() : scratch.b.data();
+        layers[l].forward(current, next);
+        current = next;
+    }
+    layers.back().forward(current, outputs);
+}
+
+/**
+ * @brief Predicts a list of samples.
+ * 
+ * @param inputs One vector of inputSize() values per sample.
+ * @return One vector of outputSize() values per sample.
+ */
+template <typename T>
+vector<vector<T>> DenseNetwork<T>::predict(const vector<vector<T>>& inputs)
+{
+    vector<vector<T>> outputs(inputs.size(), vector<T>(outputSize()));
+    for (size_t n = 0; n < inputs.size(); ++n) {
+        if ((int)inputs[n].size() != inputSize()) {
+            std::cerr << "\033[1;31mDense network input size mismatch\033[0m" << std::endl;
+            throw std::invalid_argument("Dense network input size mismatch");
+        }
+        predict(inputs[n].data(), outputs[n].data());
+    }
+    return outputs;
+}
+
+/**
+ * @brief Predicts a batch of samples stored contiguously, without allocating.
+ * 
+ * Samples go through the network BATCH_BLOCK at a time, each layer running as a
+ * matrix-matrix product over the block.
+ * 
+ * @param inputs Pointer to count rows of inputSize() values ([count x inputSize()]).
+ * @param count The number of samples.
+ * @param outputs Pointer to count rows of outputSize() values ([count x outputSize()]).
+ */
+template <typename T>
+void DenseNetwork<T>::predictBatch(const T* inputs, size_t count, T* outputs)
+{
+    predictBatch(inputs, count, outputs, scratch);
+}
+
+/**
+ * @brief Predicts a batch of samples without modifying the network.
+ * 
+ * @param inputs Pointer to count rows of inputSize() values ([count x inputSize()]).
+ * @param count The number of samples.
+ * @param outputs Pointer to count rows of outputSize() values ([count x outputSize()]).
+ * @param scratch Buffers owned by the calling thread.
+ */
+template <typename T>
+void DenseNetwork<T>::predictBatch(const T* inputs, size_t count, T* outputs, Scratch& scratch) const
+{
+    if (layers.empty()) {
+        return;
+    }
+    if (scratch.batchA.size() < widest * BATCH_BLOCK) {
+        scratch.batchA.resize(widest * BATCH_BLOCK);
+        scratch.batchB.resize(widest * BATCH_BLOCK);
+    }
+
+    const size_t inputWidth = inputSize();
+    const size_t outputWidth = outputSize();
+    for (size_t start = 0; start < count; start += BATCH_BLOCK) {
+        size_t block = std::min(BATCH_BLOCK, count - start);
+        const T* current = inputs + start * inputWidth;
+        for (size_t l = 0; l + 1 < layers.size(); ++l) {
+            T* next = (l % 2 == 0) ? scratch.batchA.data() : scratch.batchB.data();
+            layers[l].forwardBatch(current, block, next);
+            current = next;
+        }
+        layers.back().forwardBatch(current, block, outputs + start * outputWidth);
+    }
+}
+
+/**
+ * @brief Removes every layer and frees the scratch buffers.
+ */
+template <typename T>
+void DenseNetwork<T>::clearModel()
+{
+    layers.clear();
+    layers.shrink_to_fit();
+    scratch = Scratch();
+    widest = 0;
+    mapping.reset();
+}
+
+template <typename T>
+const size_t DenseNetwork<T>::BATCH_BLOCK;
+
+/**
+ * @brief Sizes the hidden activation buffers for the widest layer.
+ */
+template <typename T>
+void DenseNetwork<T>::reserveScratch()
+{
+    widest = 0;
+    for (const auto& layer : layers) {
+        widest = std::max(widest, (size_t)layer.outputSize);
+    }
+    scratch.a.resize(widest);
+    scratch.b.resize(widest);
+    scratch.batchA.resize(widest * BATCH_BLOCK);
+    scratch.batchB.resize(widest * BATCH_BLOCK);
+}
+
+// Explicitly instantiate the template for the types you need
+template class DenseLayer<float>;
+template class DenseLayer<double>;
+template class DenseNetwork<float>;
+template class DenseNetwork<double>;
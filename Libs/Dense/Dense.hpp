@@ -0,0 +1,176 @@
+// ****************************************************
+// * Code by Kidsadakorn Nuallaoong
+// * Neural Network - Dense Layer
+// * Fused fully connected layers for MLP inference
+// ****************************************************
+
+#if !defined(DENSE_H)
+#define DENSE_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <iostream>
+#include "../Activation/Activation.hpp"
+#include "../Perceptron/Perceptron.hpp"
+
+using namespace std;
+
+// * Binary model file (model.bin), see DenseNetwork::export_to_binary
+#define MODEL_FILE_MAGIC "EFMODEL"
+#define MODEL_FILE_VERSION 1
+#define MODEL_FILE_ALIGN 64
+
+enum ModelDType {
+    DTYPE_FLOAT32 = 0,
+    DTYPE_FLOAT64 = 1
+};
+
+/**
+ * @brief Header at offset 0 of a binary model file.
+ *
+ * Followed by layerCount ModelFileLayer entries, then the weight and bias blocks,
+ * each aligned to MODEL_FILE_ALIGN bytes so they can be used in place once mapped.
+ * All values are stored in host byte order.
+ */
+struct ModelFileHeader
+{
+    char magic[8];          // * MODEL_FILE_MAGIC, zero padded
+    uint32_t version;       // * MODEL_FILE_VERSION
+    uint32_t dtype;         // * ModelDType of every block
+    uint32_t layerCount;
+    uint32_t reserved;
+    uint64_t fileSize;
+    uint8_t padding[32];
+};
+
+/**
+ * @brief Shape, activation and block offsets of one layer in a binary model file.
+ */
+struct ModelFileLayer
+{
+    uint32_t inputSize;
+    uint32_t outputSize;
+    uint32_t activation;    // * ActivationType
+    uint32_t precision;     // * ActivationPrecision, 0 (exact) in files written before it existed
+    uint64_t weightsOffset; // * row-major [outputSize x inputSize]
+    uint64_t biasOffset;    // * [outputSize]
+};
+
+/**
+ * @brief A whole fully connected layer stored as one contiguous weight matrix.
+ *
+ * Weights are row-major [outputSize x inputSize] (one row per neuron) next to a
+ * bias vector, so evaluating the layer is a single GEMV over contiguous memory
+ * instead of one heap allocation per Perceptron.
+ */
+template <typename T>
+class DenseLayer
+{
+    public:
+        int inputSize = 0;
+        int outputSize = 0;
+
+        vector<T> weights = vector<T>(); // * row-major [outputSize x inputSize]
+        vector<T> bias = vector<T>();
+
+        // * when set, the layer reads its parameters from here instead (e.g. a mapped model file)
+        const T* weightsView = nullptr;
+        const T* biasView = nullptr;
+
+        ActivationType activationKind = LINEAR;
+        ActivationPrecision activationPrecision = PRECISION_EXACT;
+
+    public:
+        DenseLayer();
+        DenseLayer(int inputSize, int outputSize);
+        DenseLayer(const vector<Perceptron<T>>& neurons);
+
+        void init(int inputSize, int outputSize);
+
+        void setNeuron(const int index, const vector<T>& weights, const T bias);
+
+        void typeActivation(string type);
+        void typeActivation(ActivationType type);
+
+        void forward(const T* inputs, T* outputs) const;
+        vector<T> forward(const vector<T>& inputs) const;
+        void forwardBatch(const T* inputs, size_t count, T* outputs) const;
+
+        const T* weightData() const;
+        const T* biasData() const;
+
+        void display();
+};
+
+/**
+ * @brief A feed-forward network made of DenseLayer, used for inference.
+ *
+ * Loads the same model.json layout written by MultiLayerPerceptron
+ * ({"layers": [{"activation", "nodes": [{"bias", "weights"}]}]}, with an optional
+ * top-level "activationPrecision") or the binary model file, which is mapped and
+ * used in place without parsing.
+ *
+ * The const predict / predictBatch overloads keep the hidden activations in a
+ * caller-owned Scratch, so any number of threads can share one loaded network (one
+ * Scratch per thread). The overloads without a Scratch use one owned by the network
+ * and must not run concurrently.
+ */
+template <typename T>
+class DenseNetwork
+{
+    public:
+        vector<DenseLayer<T>> layers = vector<DenseLayer<T>>();
+
+        /**
+         * @brief Hidden activation buffers of one caller, grown on first use then reused.
+         */
+        struct Scratch
+        {
+            vector<T> a = vector<T>();
+            vector<T> b = vector<T>();
+            vector<T> batchA = vector<T>();
+            vector<T> batchB = vector<T>();
+        };
+
+    public:
+        DenseNetwork();
+        ~DenseNetwork();
+
+        void addLayer(const DenseLayer<T>& layer);
+
+        void import_from_json(const string& filename);
+        void import_from_binary(const string& filename);
+        void export_to_binary(const string& filename) const;
+
+        int inputSize() const;
+        int outputSize() const;
+
+        void setActivationPrecision(ActivationPrecision precision);
+
+        void predict(const T* inputs, T* outputs);
+        void predict(const T* inputs, T* outputs, Scratch& scratch) const;
+        vector<vector<T>> predict(const vector<vector<T>>& inputs);
+        void predictBatch(const T* inputs, size_t count, T* outputs);
+        void predictBatch(const T* inputs, size_t count, T* outputs, Scratch& scratch) const;
+
+        void clearModel();
+
+    private:
+        // * samples evaluated together by predictBatch, keeps the hidden activations in cache
+        static const size_t BATCH_BLOCK = 64;
+
+        // * ping-pong buffers for the hidden activations of the overloads without a Scratch, sized on load
+        Scratch scratch = Scratch();
+
+        // * outputs of the widest layer, the size of a hidden activation buffer
+        size_t widest = 0;
+
+        // * keeps a mapped model file alive while layers point into it
+        shared_ptr<const void> mapping = nullptr;
+
+        void reserveScratch();
+};
+
+#endif // DENSE_H
@@ -0,0 +1,227 @@
+/**
+ * @file Half.cpp
+ * @brief Implementation of the HalfLayer and HalfNetwork classes.
+ *
+ * Weights stored in fp16 or bf16 and widened to float inside KernelsHalf::dot,
+ * activations, bias and accumulation in float.
+ */
+
+#include "Half.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+using std::vector;
+
+
+/**
+ * @brief Default constructor for the HalfLayer class.
+ */
+HalfLayer::HalfLayer()
+{
+}
+
+/**
+ * @brief Rounds the weights of a dense layer to half precision.
+ *
+ * @param layer The floating point layer.
+ * @param format fp16 or bf16.
+ */
+template <typename T>
+void HalfLayer::convert(const DenseLayer<T>& layer, HalfFormat format)
+{
+    inputSize = layer.inputSize;
+    outputSize = layer.outputSize;
+    activationKind = layer.activationKind;
+    activationPrecision = layer.activationPrecision;
+    this->format = format;
+    weights.resize((size_t)inputSize * outputSize);
+    bias.resize(outputSize);
+
+    const T* source = layer.weightData();
+    const T* b = layer.biasData();
+    vector<float> row(inputSize);
+    for (int o = 0; o < outputSize; ++o, source += inputSize) {
+        std::copy(source, source + inputSize, row.begin());
+        KernelsHalf::narrow(format, row.data(), inputSize, weights.data() + (size_t)o * inputSize);
+        bias[o] = (float)b[o];
+    }
+}
+
+/**
+ * @brief Evaluates the layer: outputs = activation(widen(W) * inputs + bias).
+ *
+ * @param inputs Pointer to inputSize values.
+ * @param outputs Pointer to outputSize values, must not alias inputs.
+ */
+void HalfLayer::forward(const float* inputs, float* outputs) const
+{
+    const uint16_t* row = weights.data();
+    for (int o = 0; o < outputSize; ++o, row += inputSize) {
+        outputs[o] = bias[o] + KernelsHalf::dot(format, row, inputs, inputSize);
+    }
+
+    Kernels<float>::activate(activationKind, outputs, outputSize, activationPrecision);
+}
+
+/**
+ * @brief Default constructor for the HalfNetwork class.
+ */
+HalfNetwork::HalfNetwork()
+{
+}
+
+/**
+ * @brief Builds the half precision network from a loaded floating point network.
+ *
+ * @param reference The network to convert, left unchanged.
+ * @param format fp16 or bf16.
+ */
+template <typename T>
+void HalfNetwork::convert(const DenseNetwork<T>& reference, HalfFormat format)
+{
+    clearModel();
+    layers.resize(reference.layers.size());
+    for (size_t l = 0; l < layers.size(); ++l) {
+        layers[l].convert(reference.layers[l], format);
+        widest = std::max(widest, (size_t)layers[l].outputSize);
+    }
+    reserve(scratch);
+}
+
+/**
+ * @brief Compares the half precision predictions with the reference network.
+ *
+ * @param reference The network this one was converted from.
+ * @param calibration Representative inputs, one vector of inputSize() values per sample.
+ * @return The error statistics over every output of every sample.
+ */
+template <typename T>
+QuantizationReport HalfNetwork::evaluate(const DenseNetwork<T>& reference, const vector<vector<T>>& calibration) const
+{
+    Scratch scratch;
+    return compareWithReference("Half precision", reference, calibration, inputSize(), outputSize(),
+                                [&](const float* inputs, float* outputs) { predict(inputs, outputs, scratch); });
+}
+
+/**
+ * @brief Returns the number of inputs of the network.
+ */
+int HalfNetwork::inputSize() const
+{
+    return layers.empty() ? 0 : layers.front().inputSize;
+}
+
+/**
+ * @brief Returns the number of outputs of the network.
+ */
+int HalfNetwork::outputSize() const
+{
+    return layers.empty() ? 0 : layers.back().outputSize;
+}
+
+/**
+ * @brief Returns the memory taken by the weights and biases.
+ */
+size_t HalfNetwork::weightBytes() const
+{
+    size_t total = 0;
+    for (const auto& layer : layers) {
+        total += layer.weights.size() * sizeof(uint16_t) + layer.bias.size() * sizeof(float);
+    }
+    return total;
+}
+
+/**
+ * @brief Predicts one sample without allocating.
+ *
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ */
+void HalfNetwork::predict(const float* inputs, float* outputs)
+{
+    predict(inputs, outputs, scratch);
+}
+
+/**
+ * @brief Predicts one sample given in double precision, without allocating.
+ *
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ */
+void HalfNetwork::predict(const double* inputs, double* outputs)
+{
+    predict(inputs, outputs, scratch);
+}
+
+/**
+ * @brief Predicts one sample without modifying the network.
+ *
+ * Reentrant: the hidden activations live in the caller's scratch, which only
+ * allocates the first time it is used with this network.
+ *
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ * @param scratch Buffers owned by the calling thread.
+ */
+void HalfNetwork::predict(const float* inputs, float* outputs, Scratch& scratch) const
+{
+    if (layers.empty()) {
+        return;
+    }
+    reserve(scratch);
+
+    const float* current = inputs;
+    for (size_t l = 0; l + 1 < layers.size(); ++l) {
+        float* next = (l % 2 == 0) ? scratch.a.data() : scratch.b.data();
+        layers[l].forward(current, next);
+        current = next;
+    }
+    layers.back().forward(current, outputs);
+}
+
+/**
+ * @brief Predicts one sample given in double precision without modifying the network.
+ *
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ * @param scratch Buffers owned by the calling thread.
+ */
+void HalfNetwork::predict(const double* inputs, double* outputs, Scratch& scratch) const
+{
+    if (layers.empty()) {
+        return;
+    }
+    reserve(scratch);
+
+    predictConverted(scratch, inputs, outputs, inputSize(), outputSize(),
+                     [&](const float* in, float* out) { predict(in, out, scratch); });
+}
+
+/**
+ * @brief Grows the buffers of a scratch to fit this network, no-op once they do.
+ */
+void HalfNetwork::reserve(Scratch& scratch) const
+{
+    scratch.reserve(widest, inputSize(), outputSize());
+}
+
+/**
+ * @brief Removes every layer and frees the scratch buffers.
+ */
+void HalfNetwork::clearModel()
+{
+    layers.clear();
+    layers.shrink_to_fit();
+    scratch = Scratch();
+    widest = 0;
+}
+
+// Explicitly instantiate the templates for the types you need
+template void HalfLayer::convert<float>(const DenseLayer<float>&, HalfFormat);
+template void HalfLayer::convert<double>(const DenseLayer<double>&, HalfFormat);
+template void HalfNetwork::convert<float>(const DenseNetwork<float>&, HalfFormat);
+template void HalfNetwork::convert<double>(const DenseNetwork<double>&, HalfFormat);
+template QuantizationReport HalfNetwork::evaluate<float>(const DenseNetwork<float>&, const vector<vector<float>>&) const;
+template QuantizationReport HalfNetwork::evaluate<double>(const DenseNetwork<double>&, const vector<vector<double>>&) const;
@@ -0,0 +1,100 @@
+// ****************************************************
+// * Code by Kidsadakorn Nuallaoong
+// * Neural Network - Half Layer
+// * fp16 / bf16 weight storage for MLP inference
+// ****************************************************
+
+#if !defined(HALF_H)
+#define HALF_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "../Activation/Activation.hpp"
+#include "../Dense/Dense.hpp"
+#include "../Kernels/Kernels.hpp"
+#include "../Quantized/Quantized.hpp"
+
+using namespace std;
+
+/**
+ * @brief A DenseLayer whose weights are stored in 16 bits (fp16 or bf16).
+ *
+ * The weights are rounded to nearest once, on convert(); forward() widens them to
+ * float in registers (KernelsHalf::dot) and accumulates in float. The bias stays in
+ * float, it is one value per neuron.
+ */
+class HalfLayer
+{
+    public:
+        int inputSize = 0;
+        int outputSize = 0;
+
+        HalfFormat format = HALF_FP16;
+        vector<uint16_t> weights = vector<uint16_t>(); // * row-major [outputSize x inputSize]
+        vector<float> bias = vector<float>();
+
+        ActivationType activationKind = LINEAR;
+        ActivationPrecision activationPrecision = PRECISION_EXACT;
+
+    public:
+        HalfLayer();
+
+        template <typename T>
+        void convert(const DenseLayer<T>& layer, HalfFormat format);
+
+        void forward(const float* inputs, float* outputs) const;
+};
+
+/**
+ * @brief Inference engine with half precision weights, built from a loaded DenseNetwork.
+ *
+ * The weights take half the float size and a quarter of double, which halves the
+ * memory traffic of every prediction. fp16 keeps 11 significant bits over +-65504,
+ * bf16 keeps 8 bits over the whole float range. evaluate() reports the accuracy delta
+ * against the reference network like QuantizedNetwork::evaluate.
+ *
+ * The const predict overloads take a caller-owned Scratch and can run concurrently
+ * on one network; the overloads without one must not.
+ */
+class HalfNetwork
+{
+    public:
+        vector<HalfLayer> layers = vector<HalfLayer>();
+
+        /**
+         * @brief Per-caller buffers of predict, grown on first use then reused.
+         */
+        typedef EngineScratch Scratch;
+
+    public:
+        HalfNetwork();
+
+        template <typename T>
+        void convert(const DenseNetwork<T>& reference, HalfFormat format);
+
+        template <typename T>
+        QuantizationReport evaluate(const DenseNetwork<T>& reference, const vector<vector<T>>& calibration) const;
+
+        int inputSize() const;
+        int outputSize() const;
+        size_t weightBytes() const;
+
+        void predict(const float* inputs, float* outputs);
+        void predict(const double* inputs, double* outputs);
+        void predict(const float* inputs, float* outputs, Scratch& scratch) const;
+        void predict(const double* inputs, double* outputs, Scratch& scratch) const;
+
+        void clearModel();
+
+    private:
+        // * buffers of the overloads without a Scratch, sized on convert
+        Scratch scratch = Scratch();
+
+        // * outputs of the widest layer, the size of a hidden activation buffer
+        size_t widest = 0;
+
+        void reserve(Scratch& scratch) const;
+};
+
+#endif // HALF_H
@@ -0,0 +1,1819 @@
+/**
+ * @file Kernels.cpp
+ * @brief SIMD implementations of the inference kernels with runtime dispatch.
+ *
+ * Every kernel exists in a scalar version and, depending on the target, in SSE2 and
+ * AVX2+FMA (x86_64) or NEON (aarch64) versions. A table of function pointers is filled
+ * once from the CPU features, callers only pay one indirect call per kernel.
+ *
+ * @tparam T The data type for the kernels (float or double).
+ */
+
+#include "Kernels.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define KERNELS_X86 1
+    #include <immintrin.h>
+    #define KERNELS_AVX2 __attribute__((target("avx2,fma")))
+    #define KERNELS_F16C __attribute__((target("avx2,fma,f16c")))
+#elif defined(__aarch64__)
+    #define KERNELS_NEON 1
+    #include <arm_neon.h>
+#endif
+
+using namespace std;
+
+// * exp range limits (inputs are clamped so that 2^n stays a normal number)
+static const float  EXP_HI_F = 88.3762626647949f;
+static const float  EXP_LO_F = -87.3365447504f;
+static const double EXP_HI_D = 709.0;
+static const double EXP_LO_D = -708.0;
+
+static const float  LOG2E_F = 1.44269504088896341f;
+static const float  LN2_HI_F = 0.693359375f;
+static const float  LN2_LO_F = -2.12194440e-4f;
+static const double LOG2E_D = 1.44269504088896340736;
+static const double LN2_HI_D = 6.93147180369123816490e-01;
+static const double LN2_LO_D = 1.90821492927058770002e-10;
+
+// * adding then subtracting these rounds to the nearest integer
+static const float  ROUND_F = 12582912.0f;          // 1.5 * 2^23
+static const double ROUND_D = 6755399441055744.0;   // 1.5 * 2^52
+
+/**
+ * @brief Function table for one implementation of the kernels.
+ */
+template <typename T>
+struct KernelTable
+{
+    const char* name;
+    T (*dot)(const T*, const T*, size_t);
+    void (*sigmoid)(T*, size_t);
+    void (*tanh)(T*, size_t);
+    void (*relu)(T*, size_t);
+    void (*leakyrelu)(T*, size_t);
+    void (*dot4)(const T*, const T*, size_t, size_t, T*);
+    // * approximate tanh, x[i] = offset + outScale * tanh(inScale * x[i]) covers sigmoid as well
+    void (*tanhRational)(T*, size_t, T, T, T);
+    void (*tanhTable)(T*, size_t, T, T, T);
+};
+
+// ----------------------------------------------------
+// * Scalar
+// ----------------------------------------------------
+
+template <typename T>
+static T dotScalar(const T* a, const T* b, size_t n)
+{
+    T total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+template <typename T>
+static void sigmoidScalar(T* x, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = Activation<T>::sigmoid(x[i]);
+    }
+}
+
+template <typename T>
+static void tanhScalar(T* x, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = Activation<T>::tanh(x[i]);
+    }
+}
+
+template <typename T>
+static void reluScalar(T* x, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = Activation<T>::relu(x[i]);
+    }
+}
+
+template <typename T>
+static void leakyreluScalar(T* x, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = Activation<T>::leakyrelu(x[i]);
+    }
+}
+
+template <typename T>
+static void dot4Scalar(const T* w, const T* x, size_t stride, size_t n, T* out)
+{
+    for (size_t k = 0; k < 4; ++k) {
+        out[k] = dotScalar(w, x + k * stride, n);
+    }
+}
+
+template <typename T>
+static void tanhRationalScalar(T* x, size_t n, T inScale, T outScale, T offset)
+{
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = offset + outScale * TanhRational::eval(inScale * x[i]);
+    }
+}
+
+template <typename T>
+static void tanhTableScalar(T* x, size_t n, T inScale, T outScale, T offset)
+{
+    const TanhTable& table = TanhTable::get();
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = offset + outScale * table.eval(inScale * x[i]);
+    }
+}
+
+template <typename T>
+static KernelTable<T> scalarTable()
+{
+    return { "scalar", &dotScalar<T>, &sigmoidScalar<T>, &tanhScalar<T>, &reluScalar<T>, &leakyreluScalar<T>, &dot4Scalar<T>,
+             &tanhRationalScalar<T>, &tanhTableScalar<T> };
+}
+
+#if defined(KERNELS_X86)
+// ----------------------------------------------------
+// * SSE2 (always available on x86_64)
+// ----------------------------------------------------
+
+static inline __m128 exp_sse2(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(EXP_LO_F)), _mm_set1_ps(EXP_HI_F));
+    __m128 n = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(LOG2E_F)), _mm_set1_ps(ROUND_F)), _mm_set1_ps(ROUND_F));
+    __m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(LN2_HI_F))), _mm_mul_ps(n, _mm_set1_ps(LN2_LO_F)));
+    __m128 p = _mm_set1_ps(1.9875691500e-4f);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.3981999507e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+    p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, r), r), r), _mm_set1_ps(1.0f));
+    __m128i k = _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(n, _mm_set1_ps(127.0f))), 23);
+    return _mm_mul_ps(p, _mm_castsi128_ps(k));
+}
+
+static inline __m128d exp_sse2(__m128d x)
+{
+    x = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(EXP_LO_D)), _mm_set1_pd(EXP_HI_D));
+    __m128d n = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(LOG2E_D)), _mm_set1_pd(ROUND_D)), _mm_set1_pd(ROUND_D));
+    __m128d r = _mm_sub_pd(_mm_sub_pd(x, _mm_mul_pd(n, _mm_set1_pd(LN2_HI_D))), _mm_mul_pd(n, _mm_set1_pd(LN2_LO_D)));
+    // * Taylor series up to r^11 / 11!, |r| <= ln2 / 2
+    __m128d p = _mm_set1_pd(1.0 / 39916800.0);
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 3628800.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 362880.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 40320.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 5040.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 720.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 120.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 24.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 6.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(0.5));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0));
+    // * 2^n built directly in the exponent field: the integer n + 1023 sits in the low mantissa bits of (n + 1023 + 2^52)
+    __m128i k = _mm_slli_epi64(_mm_castpd_si128(_mm_add_pd(n, _mm_set1_pd(1023.0 + 4503599627370496.0))), 52);
+    return _mm_mul_pd(p, _mm_castsi128_pd(k));
+}
+
+static float dotSSE2(const float* a, const float* b, size_t n)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+    float total = _mm_cvtss_f32(acc0);
+    for (; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+static double dotSSE2(const double* a, const double* b, size_t n)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    for (; i + 2 <= n; i += 2) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    acc0 = _mm_add_sd(acc0, _mm_unpackhi_pd(acc0, acc0));
+    double total = _mm_cvtsd_f64(acc0);
+    for (; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+static void sigmoidSSE2(float* x, size_t n)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 e = exp_sse2(_mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(x + i)));
+        _mm_storeu_ps(x + i, _mm_div_ps(one, _mm_add_ps(one, e)));
+    }
+    sigmoidScalar(x + i, n - i);
+}
+
+static void sigmoidSSE2(double* x, size_t n)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d e = exp_sse2(_mm_sub_pd(_mm_setzero_pd(), _mm_loadu_pd(x + i)));
+        _mm_storeu_pd(x + i, _mm_div_pd(one, _mm_add_pd(one, e)));
+    }
+    sigmoidScalar(x + i, n - i);
+}
+
+static void tanhSSE2(float* x, size_t n)
+{
+    // * tanh(x) = (1 - e^-2x) / (1 + e^-2x)
+    const __m128 one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 e = exp_sse2(_mm_mul_ps(_mm_loadu_ps(x + i), _mm_set1_ps(-2.0f)));
+        _mm_storeu_ps(x + i, _mm_div_ps(_mm_sub_ps(one, e), _mm_add_ps(one, e)));
+    }
+    tanhScalar(x + i, n - i);
+}
+
+static void tanhSSE2(double* x, size_t n)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d e = exp_sse2(_mm_mul_pd(_mm_loadu_pd(x + i), _mm_set1_pd(-2.0)));
+        _mm_storeu_pd(x + i, _mm_div_pd(_mm_sub_pd(one, e), _mm_add_pd(one, e)));
+    }
+    tanhScalar(x + i, n - i);
+}
+
+static inline __m128 tanh_rational_sse2(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-TanhRational::CLAMP)), _mm_set1_ps(TanhRational::CLAMP));
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(TanhRational::P[0]);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(TanhRational::P[1]));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(TanhRational::P[2]));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(TanhRational::P[3]));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(TanhRational::P[4]));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(TanhRational::P[5]));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(TanhRational::P[6]));
+    __m128 q = _mm_set1_ps(TanhRational::Q[0]);
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(TanhRational::Q[1]));
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(TanhRational::Q[2]));
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(TanhRational::Q[3]));
+    return _mm_div_ps(_mm_mul_ps(x, p), q);
+}
+
+static inline __m128d tanh_rational_sse2(__m128d x)
+{
+    x = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(-TanhRational::CLAMP)), _mm_set1_pd(TanhRational::CLAMP));
+    __m128d x2 = _mm_mul_pd(x, x);
+    __m128d p = _mm_set1_pd(TanhRational::P[0]);
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(TanhRational::P[1]));
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(TanhRational::P[2]));
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(TanhRational::P[3]));
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(TanhRational::P[4]));
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(TanhRational::P[5]));
+    p = _mm_add_pd(_mm_mul_pd(p, x2), _mm_set1_pd(TanhRational::P[6]));
+    __m128d q = _mm_set1_pd(TanhRational::Q[0]);
+    q = _mm_add_pd(_mm_mul_pd(q, x2), _mm_set1_pd(TanhRational::Q[1]));
+    q = _mm_add_pd(_mm_mul_pd(q, x2), _mm_set1_pd(TanhRational::Q[2]));
+    q = _mm_add_pd(_mm_mul_pd(q, x2), _mm_set1_pd(TanhRational::Q[3]));
+    return _mm_div_pd(_mm_mul_pd(x, p), q);
+}
+
+static void tanhRationalSSE2(float* x, size_t n, float inScale, float outScale, float offset)
+{
+    const __m128 in = _mm_set1_ps(inScale);
+    const __m128 out = _mm_set1_ps(outScale);
+    const __m128 add = _mm_set1_ps(offset);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 t = tanh_rational_sse2(_mm_mul_ps(_mm_loadu_ps(x + i), in));
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_mul_ps(t, out), add));
+    }
+    tanhRationalScalar(x + i, n - i, inScale, outScale, offset);
+}
+
+static void tanhRationalSSE2(double* x, size_t n, double inScale, double outScale, double offset)
+{
+    const __m128d in = _mm_set1_pd(inScale);
+    const __m128d out = _mm_set1_pd(outScale);
+    const __m128d add = _mm_set1_pd(offset);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d t = tanh_rational_sse2(_mm_mul_pd(_mm_loadu_pd(x + i), in));
+        _mm_storeu_pd(x + i, _mm_add_pd(_mm_mul_pd(t, out), add));
+    }
+    tanhRationalScalar(x + i, n - i, inScale, outScale, offset);
+}
+
+static void reluSSE2(float* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(x + i, _mm_max_ps(_mm_loadu_ps(x + i), _mm_setzero_ps()));
+    }
+    reluScalar(x + i, n - i);
+}
+
+static void reluSSE2(double* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(x + i, _mm_max_pd(_mm_loadu_pd(x + i), _mm_setzero_pd()));
+    }
+    reluScalar(x + i, n - i);
+}
+
+static void leakyreluSSE2(float* x, size_t n)
+{
+    // * max(x, 0.01x) == leakyrelu(x)
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        _mm_storeu_ps(x + i, _mm_max_ps(v, _mm_mul_ps(v, _mm_set1_ps(0.01f))));
+    }
+    leakyreluScalar(x + i, n - i);
+}
+
+static void leakyreluSSE2(double* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(x + i);
+        _mm_storeu_pd(x + i, _mm_max_pd(v, _mm_mul_pd(v, _mm_set1_pd(0.01))));
+    }
+    leakyreluScalar(x + i, n - i);
+}
+
+// ----------------------------------------------------
+// * AVX2 + FMA (selected at runtime)
+// ----------------------------------------------------
+
+KERNELS_AVX2 static inline __m256 exp_avx2(__m256 x)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(EXP_LO_F)), _mm256_set1_ps(EXP_HI_F));
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(LOG2E_F)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_HI_F), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(LN2_LO_F), r);
+    __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+    p = _mm256_fmadd_ps(_mm256_mul_ps(p, r), r, _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+    __m256i k = _mm256_slli_epi32(_mm256_cvttps_epi32(_mm256_add_ps(n, _mm256_set1_ps(127.0f))), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(k));
+}
+
+KERNELS_AVX2 static inline __m256d exp_avx2(__m256d x)
+{
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_LO_D)), _mm256_set1_pd(EXP_HI_D));
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E_D)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_HI_D), x);
+    r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_LO_D), r);
+    __m256d p = _mm256_set1_pd(1.0 / 39916800.0);
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 3628800.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 362880.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 40320.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 5040.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 720.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 120.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 24.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 6.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(0.5));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+    __m256i k = _mm256_slli_epi64(_mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(1023.0 + 4503599627370496.0))), 52);
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(k));
+}
+
+KERNELS_AVX2 static float dotAVX2(const float* a, const float* b, size_t n)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    float total = _mm_cvtss_f32(sum);
+    for (; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+KERNELS_AVX2 static double dotAVX2(const double* a, const double* b, size_t n)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+    double total = _mm_cvtsd_f64(sum);
+    for (; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+KERNELS_AVX2 static void sigmoidAVX2(float* x, size_t n)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 e = exp_avx2(_mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(x + i)));
+        _mm256_storeu_ps(x + i, _mm256_div_ps(one, _mm256_add_ps(one, e)));
+    }
+    sigmoidSSE2(x + i, n - i);
+}
+
+KERNELS_AVX2 static void sigmoidAVX2(double* x, size_t n)
+{
+    const __m256d one = _mm256_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d e = exp_avx2(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_loadu_pd(x + i)));
+        _mm256_storeu_pd(x + i, _mm256_div_pd(one, _mm256_add_pd(one, e)));
+    }
+    sigmoidSSE2(x + i, n - i);
+}
+
+KERNELS_AVX2 static void tanhAVX2(float* x, size_t n)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 e = exp_avx2(_mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_set1_ps(-2.0f)));
+        _mm256_storeu_ps(x + i, _mm256_div_ps(_mm256_sub_ps(one, e), _mm256_add_ps(one, e)));
+    }
+    tanhSSE2(x + i, n - i);
+}
+
+KERNELS_AVX2 static void tanhAVX2(double* x, size_t n)
+{
+    const __m256d one = _mm256_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d e = exp_avx2(_mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_set1_pd(-2.0)));
+        _mm256_storeu_pd(x + i, _mm256_div_pd(_mm256_sub_pd(one, e), _mm256_add_pd(one, e)));
+    }
+    tanhSSE2(x + i, n - i);
+}
+
+KERNELS_AVX2 static inline __m256 tanh_rational_avx2(__m256 x)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-TanhRational::CLAMP)), _mm256_set1_ps(TanhRational::CLAMP));
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(TanhRational::P[0]);
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(TanhRational::P[1]));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(TanhRational::P[2]));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(TanhRational::P[3]));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(TanhRational::P[4]));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(TanhRational::P[5]));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(TanhRational::P[6]));
+    __m256 q = _mm256_set1_ps(TanhRational::Q[0]);
+    q = _mm256_fmadd_ps(q, x2, _mm256_set1_ps(TanhRational::Q[1]));
+    q = _mm256_fmadd_ps(q, x2, _mm256_set1_ps(TanhRational::Q[2]));
+    q = _mm256_fmadd_ps(q, x2, _mm256_set1_ps(TanhRational::Q[3]));
+    return _mm256_div_ps(_mm256_mul_ps(x, p), q);
+}
+
+KERNELS_AVX2 static inline __m256d tanh_rational_avx2(__m256d x)
+{
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-TanhRational::CLAMP)), _mm256_set1_pd(TanhRational::CLAMP));
+    __m256d x2 = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_set1_pd(TanhRational::P[0]);
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(TanhRational::P[1]));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(TanhRational::P[2]));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(TanhRational::P[3]));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(TanhRational::P[4]));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(TanhRational::P[5]));
+    p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(TanhRational::P[6]));
+    __m256d q = _mm256_set1_pd(TanhRational::Q[0]);
+    q = _mm256_fmadd_pd(q, x2, _mm256_set1_pd(TanhRational::Q[1]));
+    q = _mm256_fmadd_pd(q, x2, _mm256_set1_pd(TanhRational::Q[2]));
+    q = _mm256_fmadd_pd(q, x2, _mm256_set1_pd(TanhRational::Q[3]));
+    return _mm256_div_pd(_mm256_mul_pd(x, p), q);
+}
+
+KERNELS_AVX2 static void tanhRationalAVX2(float* x, size_t n, float inScale, float outScale, float offset)
+{
+    const __m256 in = _mm256_set1_ps(inScale);
+    const __m256 out = _mm256_set1_ps(outScale);
+    const __m256 add = _mm256_set1_ps(offset);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 t = tanh_rational_avx2(_mm256_mul_ps(_mm256_loadu_ps(x + i), in));
+        _mm256_storeu_ps(x + i, _mm256_fmadd_ps(t, out, add));
+    }
+    for (; i < n; ++i) {
+        x[i] = offset + outScale * TanhRational::eval(inScale * x[i]);
+    }
+}
+
+KERNELS_AVX2 static void tanhRationalAVX2(double* x, size_t n, double inScale, double outScale, double offset)
+{
+    const __m256d in = _mm256_set1_pd(inScale);
+    const __m256d out = _mm256_set1_pd(outScale);
+    const __m256d add = _mm256_set1_pd(offset);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d t = tanh_rational_avx2(_mm256_mul_pd(_mm256_loadu_pd(x + i), in));
+        _mm256_storeu_pd(x + i, _mm256_fmadd_pd(t, out, add));
+    }
+    for (; i < n; ++i) {
+        x[i] = offset + outScale * TanhRational::eval(inScale * x[i]);
+    }
+}
+
+// * the table lookup gathers the two neighbouring samples of every lane
+KERNELS_AVX2 static void tanhTableAVX2(float* x, size_t n, float inScale, float outScale, float offset)
+{
+    const TanhTable& table = TanhTable::get();
+    const __m256 in = _mm256_set1_ps(inScale * TanhTable::SCALE);
+    const __m256 out = _mm256_set1_ps(outScale);
+    const __m256 add = _mm256_set1_ps(offset);
+    const __m256 limit = _mm256_set1_ps((float)TanhTable::SIZE);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(x + i), in);
+        __m256 sign = _mm256_and_ps(v, signMask);
+        // * min returns its second operand for nan, so the index stays in bounds
+        __m256 t = _mm256_min_ps(_mm256_andnot_ps(signMask, v), limit);
+        __m256i index = _mm256_cvttps_epi32(t);
+        __m256 f = _mm256_sub_ps(t, _mm256_cvtepi32_ps(index));
+        __m256 y0 = _mm256_i32gather_ps(table.values, index, 4);
+        __m256 y1 = _mm256_i32gather_ps(table.values + 1, index, 4);
+        __m256 y = _mm256_or_ps(_mm256_fmadd_ps(f, _mm256_sub_ps(y1, y0), y0), sign);
+        _mm256_storeu_ps(x + i, _mm256_fmadd_ps(y, out, add));
+    }
+    for (; i < n; ++i) {
+        x[i] = offset + outScale * table.eval(inScale * x[i]);
+    }
+}
+
+KERNELS_AVX2 static void tanhTableAVX2(double* x, size_t n, double inScale, double outScale, double offset)
+{
+    const TanhTable& table = TanhTable::get();
+    const __m256d in = _mm256_set1_pd(inScale * TanhTable::SCALE);
+    const __m256d out = _mm256_set1_pd(outScale);
+    const __m256d add = _mm256_set1_pd(offset);
+    const __m256d limit = _mm256_set1_pd((double)TanhTable::SIZE);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_mul_pd(_mm256_loadu_pd(x + i), in);
+        __m256d sign = _mm256_and_pd(v, signMask);
+        __m256d t = _mm256_min_pd(_mm256_andnot_pd(signMask, v), limit);
+        __m128i index = _mm256_cvttpd_epi32(t);
+        __m256d f = _mm256_sub_pd(t, _mm256_cvtepi32_pd(index));
+        __m256d y0 = _mm256_cvtps_pd(_mm_i32gather_ps(table.values, index, 4));
+        __m256d y1 = _mm256_cvtps_pd(_mm_i32gather_ps(table.values + 1, index, 4));
+        __m256d y = _mm256_or_pd(_mm256_fmadd_pd(f, _mm256_sub_pd(y1, y0), y0), sign);
+        _mm256_storeu_pd(x + i, _mm256_fmadd_pd(y, out, add));
+    }
+    for (; i < n; ++i) {
+        x[i] = offset + outScale * table.eval(inScale * x[i]);
+    }
+}
+
+KERNELS_AVX2 static void reluAVX2(float* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(x + i, _mm256_max_ps(_mm256_loadu_ps(x + i), _mm256_setzero_ps()));
+    }
+    reluSSE2(x + i, n - i);
+}
+
+KERNELS_AVX2 static void reluAVX2(double* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(x + i, _mm256_max_pd(_mm256_loadu_pd(x + i), _mm256_setzero_pd()));
+    }
+    reluSSE2(x + i, n - i);
+}
+
+KERNELS_AVX2 static void leakyreluAVX2(float* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        _mm256_storeu_ps(x + i, _mm256_max_ps(v, _mm256_mul_ps(v, _mm256_set1_ps(0.01f))));
+    }
+    leakyreluSSE2(x + i, n - i);
+}
+
+KERNELS_AVX2 static void leakyreluAVX2(double* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(x + i);
+        _mm256_storeu_pd(x + i, _mm256_max_pd(v, _mm256_mul_pd(v, _mm256_set1_pd(0.01))));
+    }
+    leakyreluSSE2(x + i, n - i);
+}
+
+static inline float hsum_sse2(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+static inline double hsum_sse2(__m128d v)
+{
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static void dot4SSE2(const float* w, const float* x, size_t stride, size_t n, float* out)
+{
+    const float* x0 = x;
+    const float* x1 = x + stride;
+    const float* x2 = x + 2 * stride;
+    const float* x3 = x + 3 * stride;
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps(), acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 wv = _mm_loadu_ps(w + i);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(wv, _mm_loadu_ps(x0 + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(wv, _mm_loadu_ps(x1 + i)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(wv, _mm_loadu_ps(x2 + i)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(wv, _mm_loadu_ps(x3 + i)));
+    }
+    out[0] = hsum_sse2(acc0) + dotScalar(w + i, x0 + i, n - i);
+    out[1] = hsum_sse2(acc1) + dotScalar(w + i, x1 + i, n - i);
+    out[2] = hsum_sse2(acc2) + dotScalar(w + i, x2 + i, n - i);
+    out[3] = hsum_sse2(acc3) + dotScalar(w + i, x3 + i, n - i);
+}
+
+static void dot4SSE2(const double* w, const double* x, size_t stride, size_t n, double* out)
+{
+    const double* x0 = x;
+    const double* x1 = x + stride;
+    const double* x2 = x + 2 * stride;
+    const double* x3 = x + 3 * stride;
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd(), acc2 = _mm_setzero_pd(), acc3 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d wv = _mm_loadu_pd(w + i);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(wv, _mm_loadu_pd(x0 + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(wv, _mm_loadu_pd(x1 + i)));
+        acc2 = _mm_add_pd(acc2, _mm_mul_pd(wv, _mm_loadu_pd(x2 + i)));
+        acc3 = _mm_add_pd(acc3, _mm_mul_pd(wv, _mm_loadu_pd(x3 + i)));
+    }
+    out[0] = hsum_sse2(acc0) + dotScalar(w + i, x0 + i, n - i);
+    out[1] = hsum_sse2(acc1) + dotScalar(w + i, x1 + i, n - i);
+    out[2] = hsum_sse2(acc2) + dotScalar(w + i, x2 + i, n - i);
+    out[3] = hsum_sse2(acc3) + dotScalar(w + i, x3 + i, n - i);
+}
+
+KERNELS_AVX2 static inline float hsum_avx2(__m256 v)
+{
+    return hsum_sse2(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+KERNELS_AVX2 static inline double hsum_avx2(__m256d v)
+{
+    return hsum_sse2(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+}
+
+KERNELS_AVX2 static void dot4AVX2(const float* w, const float* x, size_t stride, size_t n, float* out)
+{
+    const float* x0 = x;
+    const float* x1 = x + stride;
+    const float* x2 = x + 2 * stride;
+    const float* x3 = x + 3 * stride;
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps(), acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 wv = _mm256_loadu_ps(w + i);
+        acc0 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x0 + i), acc0);
+        acc1 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x1 + i), acc1);
+        acc2 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x2 + i), acc2);
+        acc3 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x3 + i), acc3);
+    }
+    out[0] = hsum_avx2(acc0) + dotScalar(w + i, x0 + i, n - i);
+    out[1] = hsum_avx2(acc1) + dotScalar(w + i, x1 + i, n - i);
+    out[2] = hsum_avx2(acc2) + dotScalar(w + i, x2 + i, n - i);
+    out[3] = hsum_avx2(acc3) + dotScalar(w + i, x3 + i, n - i);
+}
+
+KERNELS_AVX2 static void dot4AVX2(const double* w, const double* x, size_t stride, size_t n, double* out)
+{
+    const double* x0 = x;
+    const double* x1 = x + stride;
+    const double* x2 = x + 2 * stride;
+    const double* x3 = x + 3 * stride;
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd(), acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d wv = _mm256_loadu_pd(w + i);
+        acc0 = _mm256_fmadd_pd(wv, _mm256_loadu_pd(x0 + i), acc0);
+        acc1 = _mm256_fmadd_pd(wv, _mm256_loadu_pd(x1 + i), acc1);
+        acc2 = _mm256_fmadd_pd(wv, _mm256_loadu_pd(x2 + i), acc2);
+        acc3 = _mm256_fmadd_pd(wv, _mm256_loadu_pd(x3 + i), acc3);
+    }
+    out[0] = hsum_avx2(acc0) + dotScalar(w + i, x0 + i, n - i);
+    out[1] = hsum_avx2(acc1) + dotScalar(w + i, x1 + i, n - i);
+    out[2] = hsum_avx2(acc2) + dotScalar(w + i, x2 + i, n - i);
+    out[3] = hsum_avx2(acc3) + dotScalar(w + i, x3 + i, n - i);
+}
+
+template <typename T>
+static KernelTable<T> sse2Table()
+{
+    return { "sse2", &dotSSE2, &sigmoidSSE2, &tanhSSE2, &reluSSE2, &leakyreluSSE2, &dot4SSE2,
+             &tanhRationalSSE2, &tanhTableScalar<T> };
+}
+
+template <typename T>
+static KernelTable<T> avx2Table()
+{
+    return { "avx2", &dotAVX2, &sigmoidAVX2, &tanhAVX2, &reluAVX2, &leakyreluAVX2, &dot4AVX2,
+             &tanhRationalAVX2, &tanhTableAVX2 };
+}
+#endif // KERNELS_X86
+
+#if defined(KERNELS_NEON)
+// ----------------------------------------------------
+// * NEON (always available on aarch64)
+// ----------------------------------------------------
+
+static inline float32x4_t exp_neon(float32x4_t x)
+{
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(EXP_LO_F)), vdupq_n_f32(EXP_HI_F));
+    float32x4_t n = vrndnq_f32(vmulq_n_f32(x, LOG2E_F));
+    float32x4_t r = vfmsq_f32(x, n, vdupq_n_f32(LN2_HI_F));
+    r = vfmsq_f32(r, n, vdupq_n_f32(LN2_LO_F));
+    float32x4_t p = vdupq_n_f32(1.9875691500e-4f);
+    p = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+    p = vfmaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), vmulq_f32(p, r), r);
+    int32x4_t k = vshlq_n_s32(vcvtq_s32_f32(vaddq_f32(n, vdupq_n_f32(127.0f))), 23);
+    return vmulq_f32(p, vreinterpretq_f32_s32(k));
+}
+
+static inline float64x2_t exp_neon(float64x2_t x)
+{
+    x = vminq_f64(vmaxq_f64(x, vdupq_n_f64(EXP_LO_D)), vdupq_n_f64(EXP_HI_D));
+    float64x2_t n = vrndnq_f64(vmulq_n_f64(x, LOG2E_D));
+    float64x2_t r = vfmsq_f64(x, n, vdupq_n_f64(LN2_HI_D));
+    r = vfmsq_f64(r, n, vdupq_n_f64(LN2_LO_D));
+    float64x2_t p = vdupq_n_f64(1.0 / 39916800.0);
+    p = vfmaq_f64(vdupq_n_f64(1.0 / 3628800.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0 / 362880.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0 / 40320.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0 / 5040.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0 / 720.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0 / 120.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0 / 24.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0 / 6.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(0.5), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0), p, r);
+    p = vfmaq_f64(vdupq_n_f64(1.0), p, r);
+    int64x2_t k = vshlq_n_s64(vcvtq_s64_f64(vaddq_f64(n, vdupq_n_f64(1023.0))), 52);
+    return vmulq_f64(p, vreinterpretq_f64_s64(k));
+}
+
+static float dotNEON(const float* a, const float* b, size_t n)
+{
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float total = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+static double dotNEON(const double* a, const double* b, size_t n)
+{
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+        acc1 = vfmaq_f64(acc1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+    }
+    for (; i + 2 <= n; i += 2) {
+        acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+    }
+    double total = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+static void sigmoidNEON(float* x, size_t n)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t e = exp_neon(vnegq_f32(vld1q_f32(x + i)));
+        vst1q_f32(x + i, vdivq_f32(one, vaddq_f32(one, e)));
+    }
+    sigmoidScalar(x + i, n - i);
+}
+
+static void sigmoidNEON(double* x, size_t n)
+{
+    const float64x2_t one = vdupq_n_f64(1.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t e = exp_neon(vnegq_f64(vld1q_f64(x + i)));
+        vst1q_f64(x + i, vdivq_f64(one, vaddq_f64(one, e)));
+    }
+    sigmoidScalar(x + i, n - i);
+}
+
+static void tanhNEON(float* x, size_t n)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t e = exp_neon(vmulq_n_f32(vld1q_f32(x + i), -2.0f));
+        vst1q_f32(x + i, vdivq_f32(vsubq_f32(one, e), vaddq_f32(one, e)));
+    }
+    tanhScalar(x + i, n - i);
+}
+
+static void tanhNEON(double* x, size_t n)
+{
+    const float64x2_t one = vdupq_n_f64(1.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t e = exp_neon(vmulq_n_f64(vld1q_f64(x + i), -2.0));
+        vst1q_f64(x + i, vdivq_f64(vsubq_f64(one, e), vaddq_f64(one, e)));
+    }
+    tanhScalar(x + i, n - i);
+}
+
+static inline float32x4_t tanh_rational_neon(float32x4_t x)
+{
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-TanhRational::CLAMP)), vdupq_n_f32(TanhRational::CLAMP));
+    float32x4_t x2 = vmulq_f32(x, x);
+    float32x4_t p = vdupq_n_f32(TanhRational::P[0]);
+    p = vfmaq_f32(vdupq_n_f32(TanhRational::P[1]), p, x2);
+    p = vfmaq_f32(vdupq_n_f32(TanhRational::P[2]), p, x2);
+    p = vfmaq_f32(vdupq_n_f32(TanhRational::P[3]), p, x2);
+    p = vfmaq_f32(vdupq_n_f32(TanhRational::P[4]), p, x2);
+    p = vfmaq_f32(vdupq_n_f32(TanhRational::P[5]), p, x2);
+    p = vfmaq_f32(vdupq_n_f32(TanhRational::P[6]), p, x2);
+    float32x4_t q = vdupq_n_f32(TanhRational::Q[0]);
+    q = vfmaq_f32(vdupq_n_f32(TanhRational::Q[1]), q, x2);
+    q = vfmaq_f32(vdupq_n_f32(TanhRational::Q[2]), q, x2);
+    q = vfmaq_f32(vdupq_n_f32(TanhRational::Q[3]), q, x2);
+    return vdivq_f32(vmulq_f32(x, p), q);
+}
+
+static inline float64x2_t tanh_rational_neon(float64x2_t x)
+{
+    x = vminq_f64(vmaxq_f64(x, vdupq_n_f64(-TanhRational::CLAMP)), vdupq_n_f64(TanhRational::CLAMP));
+    float64x2_t x2 = vmulq_f64(x, x);
+    float64x2_t p = vdupq_n_f64(TanhRational::P[0]);
+    p = vfmaq_f64(vdupq_n_f64(TanhRational::P[1]), p, x2);
+    p = vfmaq_f64(vdupq_n_f64(TanhRational::P[2]), p, x2);
+    p = vfmaq_f64(vdupq_n_f64(TanhRational::P[3]), p, x2);
+    p = vfmaq_f64(vdupq_n_f64(TanhRational::P[4]), p, x2);
+    p = vfmaq_f64(vdupq_n_f64(TanhRational::P[5]), p, x2);
+    p = vfmaq_f64(vdupq_n_f64(TanhRational::P[6]), p, x2);
+    float64x2_t q = vdupq_n_f64(TanhRational::Q[0]);
+    q = vfmaq_f64(vdupq_n_f64(TanhRational::Q[1]), q, x2);
+    q = vfmaq_f64(vdupq_n_f64(TanhRational::Q[2]), q, x2);
+    q = vfmaq_f64(vdupq_n_f64(TanhRational::Q[3]), q, x2);
+    return vdivq_f64(vmulq_f64(x, p), q);
+}
+
+static void tanhRationalNEON(float* x, size_t n, float inScale, float outScale, float offset)
+{
+    const float32x4_t add = vdupq_n_f32(offset);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t t = tanh_rational_neon(vmulq_n_f32(vld1q_f32(x + i), inScale));
+        vst1q_f32(x + i, vfmaq_n_f32(add, t, outScale));
+    }
+    tanhRationalScalar(x + i, n - i, inScale, outScale, offset);
+}
+
+static void tanhRationalNEON(double* x, size_t n, double inScale, double outScale, double offset)
+{
+    const float64x2_t add = vdupq_n_f64(offset);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t t = tanh_rational_neon(vmulq_n_f64(vld1q_f64(x + i), inScale));
+        vst1q_f64(x + i, vfmaq_n_f64(add, t, outScale));
+    }
+    tanhRationalScalar(x + i, n - i, inScale, outScale, offset);
+}
+
+static void reluNEON(float* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(x + i, vmaxq_f32(vld1q_f32(x + i), vdupq_n_f32(0.0f)));
+    }
+    reluScalar(x + i, n - i);
+}
+
+static void reluNEON(double* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(x + i, vmaxq_f64(vld1q_f64(x + i), vdupq_n_f64(0.0)));
+    }
+    reluScalar(x + i, n - i);
+}
+
+static void leakyreluNEON(float* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(x + i);
+        vst1q_f32(x + i, vmaxq_f32(v, vmulq_n_f32(v, 0.01f)));
+    }
+    leakyreluScalar(x + i, n - i);
+}
+
+static void leakyreluNEON(double* x, size_t n)
+{
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vld1q_f64(x + i);
+        vst1q_f64(x + i, vmaxq_f64(v, vmulq_n_f64(v, 0.01)));
+    }
+    leakyreluScalar(x + i, n - i);
+}
+
+static void dot4NEON(const float* w, const float* x, size_t stride, size_t n, float* out)
+{
+    const float* x0 = x;
+    const float* x1 = x + stride;
+    const float* x2 = x + 2 * stride;
+    const float* x3 = x + 3 * stride;
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f), acc2 = vdupq_n_f32(0.0f), acc3 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t wv = vld1q_f32(w + i);
+        acc0 = vfmaq_f32(acc0, wv, vld1q_f32(x0 + i));
+        acc1 = vfmaq_f32(acc1, wv, vld1q_f32(x1 + i));
+        acc2 = vfmaq_f32(acc2, wv, vld1q_f32(x2 + i));
+        acc3 = vfmaq_f32(acc3, wv, vld1q_f32(x3 + i));
+    }
+    out[0] = vaddvq_f32(acc0) + dotScalar(w + i, x0 + i, n - i);
+    out[1] = vaddvq_f32(acc1) + dotScalar(w + i, x1 + i, n - i);
+    out[2] = vaddvq_f32(acc2) + dotScalar(w + i, x2 + i, n - i);
+    out[3] = vaddvq_f32(acc3) + dotScalar(w + i, x3 + i, n - i);
+}
+
+static void dot4NEON(const double* w, const double* x, size_t stride, size_t n, double* out)
+{
+    const double* x0 = x;
+    const double* x1 = x + stride;
+    const double* x2 = x + 2 * stride;
+    const double* x3 = x + 3 * stride;
+    float64x2_t acc0 = vdupq_n_f64(0.0), acc1 = vdupq_n_f64(0.0), acc2 = vdupq_n_f64(0.0), acc3 = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t wv = vld1q_f64(w + i);
+        acc0 = vfmaq_f64(acc0, wv, vld1q_f64(x0 + i));
+        acc1 = vfmaq_f64(acc1, wv, vld1q_f64(x1 + i));
+        acc2 = vfmaq_f64(acc2, wv, vld1q_f64(x2 + i));
+        acc3 = vfmaq_f64(acc3, wv, vld1q_f64(x3 + i));
+    }
+    out[0] = vaddvq_f64(acc0) + dotScalar(w + i, x0 + i, n - i);
+    out[1] = vaddvq_f64(acc1) + dotScalar(w + i, x1 + i, n - i);
+    out[2] = vaddvq_f64(acc2) + dotScalar(w + i, x2 + i, n - i);
+    out[3] = vaddvq_f64(acc3) + dotScalar(w + i, x3 + i, n - i);
+}
+
+template <typename T>
+static KernelTable<T> neonTable()
+{
+    return { "neon", &dotNEON, &sigmoidNEON, &tanhNEON, &reluNEON, &leakyreluNEON, &dot4NEON,
+             &tanhRationalNEON, &tanhTableScalar<T> };
+}
+#endif // KERNELS_NEON
+
+// ----------------------------------------------------
+// * Dispatch
+// ----------------------------------------------------
+
+/**
+ * @brief Picks the best implementation for this CPU.
+ */
+template <typename T>
+static KernelTable<T> selectTable()
+{
+    const char* forced = getenv("EDGEFRONTIER_KERNELS");
+    if (forced != nullptr && strcmp(forced, "scalar") == 0) {
+        return scalarTable<T>();
+    }
+
+#if defined(KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+        !(forced != nullptr && strcmp(forced, "sse2") == 0)) {
+        return avx2Table<T>();
+    }
+    return sse2Table<T>();
+#elif defined(KERNELS_NEON)
+    return neonTable<T>();
+#else
+    return scalarTable<T>();
+#endif
+}
+
+template <typename T>
+static const KernelTable<T>& table()
+{
+    static const KernelTable<T> active = selectTable<T>();
+    return active;
+}
+
+/**
+ * @brief Dot product of two arrays.
+ *
+ * @param a Pointer to n values.
+ * @param b Pointer to n values.
+ * @param n The number of values.
+ * @return The sum of a[i] * b[i].
+ */
+template <typename T>
+T Kernels<T>::dot(const T* a, const T* b, size_t n)
+{
+    return table<T>().dot(a, b, n);
+}
+
+/**
+ * @brief Four dot products sharing the same weight row.
+ *
+ * Computes out[k] = dot(w, x + k * stride) for k = 0..3, loading each weight once.
+ * This is the micro-kernel of the batched (matrix-matrix) layer evaluation.
+ *
+ * @param w Pointer to n weights.
+ * @param x Pointer to the first of four input rows.
+ * @param stride Distance between two input rows, in elements.
+ * @param n The number of values per row.
+ * @param out Receives the four results.
+ */
+template <typename T>
+void Kernels<T>::dot4(const T* w, const T* x, size_t stride, size_t n, T* out)
+{
+    table<T>().dot4(w, x, stride, n, out);
+}
+
+/**
+ * @brief In-place sigmoid over n values.
+ */
+template <typename T>
+void Kernels<T>::sigmoid(T* x, size_t n)
+{
+    table<T>().sigmoid(x, n);
+}
+
+/**
+ * @brief In-place tanh over n values.
+ */
+template <typename T>
+void Kernels<T>::tanh(T* x, size_t n)
+{
+    table<T>().tanh(x, n);
+}
+
+/**
+ * @brief In-place relu over n values.
+ */
+template <typename T>
+void Kernels<T>::relu(T* x, size_t n)
+{
+    table<T>().relu(x, n);
+}
+
+/**
+ * @brief In-place leaky relu (slope 0.01) over n values.
+ */
+template <typename T>
+void Kernels<T>::leakyrelu(T* x, size_t n)
+{
+    table<T>().leakyrelu(x, n);
+}
+
+/**
+ * @brief In-place softmax over n values.
+ */
+template <typename T>
+void Kernels<T>::softmax(T* x, size_t n)
+{
+    if (n == 0) {
+        return;
+    }
+
+    T maxValue = *std::max_element(x, x + n);
+    T sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = exp(x[i] - maxValue);
+        sum += x[i];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        x[i] /= sum;
+    }
+}
+
+/**
+ * @brief In-place activation of n values.
+ *
+ * @param type The activation function type.
+ * @param x Pointer to n values.
+ * @param n The number of values.
+ * @param precision Implementation of sigmoid and tanh, see ActivationPrecision.
+ */
+template <typename T>
+void Kernels<T>::activate(ActivationType type, T* x, size_t n, ActivationPrecision precision)
+{
+    if ((type == SIGMOID || type == TANH) && precision != PRECISION_EXACT) {
+        const KernelTable<T>& active = table<T>();
+        void (*approximate)(T*, size_t, T, T, T) = precision == PRECISION_TABLE ? active.tanhTable : active.tanhRational;
+        if (type == SIGMOID) {
+            approximate(x, n, T(0.5), T(0.5), T(0.5)); // * sigmoid(x) = 0.5 + 0.5 * tanh(x / 2)
+        } else {
+            approximate(x, n, T(1), T(1), T(0));
+        }
+        return;
+    }
+
+    switch (type) {
+        case LINEAR:    return;
+        case SIGMOID:   sigmoid(x, n); return;
+        case TANH:      tanh(x, n); return;
+        case RELU:      relu(x, n); return;
+        case LEAKYRELU: leakyrelu(x, n); return;
+        case SOFTMAX:   softmax(x, n); return;
+        case STEP:
+            for (size_t i = 0; i < n; ++i) {
+                x[i] = Activation<T>::step(x[i]);
+            }
+            return;
+    }
+}
+
+/**
+ * @brief Returns the name of the selected implementation.
+ */
+template <typename T>
+const char* Kernels<T>::backend()
+{
+    return table<T>().name;
+}
+
+// ----------------------------------------------------
+// * Int8
+// ----------------------------------------------------
+
+/**
+ * @brief Function table for one implementation of the int8 kernels.
+ */
+struct Int8KernelTable
+{
+    const char* name;
+    int32_t (*dot)(const int8_t*, const int8_t*, size_t);
+    void (*quantize)(const float*, size_t, float, int32_t, int8_t*);
+};
+
+static int32_t dotInt8Scalar(const int8_t* a, const int8_t* b, size_t n)
+{
+    int32_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += (int32_t)a[i] * b[i];
+    }
+    return total;
+}
+
+static void quantizeInt8Scalar(const float* x, size_t n, float inverseScale, int32_t zeroPoint, int8_t* q)
+{
+    // * clamped first, the bounds are integers so rounding afterwards gives the same result
+    for (size_t i = 0; i < n; ++i) {
+        float v = std::min(127.0f, std::max(-127.0f, x[i] * inverseScale + (float)zeroPoint));
+        q[i] = (int8_t)((v + ROUND_F) - ROUND_F);
+    }
+}
+
+#if defined(KERNELS_X86)
+// * sign-extends the 16 bytes of v into two vectors of 8 int16
+static inline void widen_sse2(__m128i v, __m128i& lo, __m128i& hi)
+{
+    __m128i sign = _mm_cmplt_epi8(v, _mm_setzero_si128());
+    lo = _mm_unpacklo_epi8(v, sign);
+    hi = _mm_unpackhi_epi8(v, sign);
+}
+
+static int32_t dotInt8SSE2(const int8_t* a, const int8_t* b, size_t n)
+{
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i alo, ahi, blo, bhi;
+        widen_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), alo, ahi);
+        widen_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)), blo, bhi);
+        // * madd multiplies int16 pairs and adds neighbours into int32 lanes
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(alo, blo));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(ahi, bhi));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc) + dotInt8Scalar(a + i, b + i, n - i);
+}
+
+// * scales, shifts and clamps 4 floats to [-127, 127] then rounds them to nearest even
+static inline __m128i quantize4_sse2(const float* x, __m128 inverse, __m128 zero)
+{
+    __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x), inverse), zero);
+    v = _mm_min_ps(_mm_set1_ps(127.0f), _mm_max_ps(_mm_set1_ps(-127.0f), v));
+    return _mm_cvtps_epi32(v);
+}
+
+static void quantizeInt8SSE2(const float* x, size_t n, float inverseScale, int32_t zeroPoint, int8_t* q)
+{
+    __m128 inverse = _mm_set1_ps(inverseScale);
+    __m128 zero = _mm_set1_ps((float)zeroPoint);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i lo = _mm_packs_epi32(quantize4_sse2(x + i, inverse, zero), quantize4_sse2(x + i + 4, inverse, zero));
+        __m128i hi = _mm_packs_epi32(quantize4_sse2(x + i + 8, inverse, zero), quantize4_sse2(x + i + 12, inverse, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(q + i), _mm_packs_epi16(lo, hi));
+    }
+    quantizeInt8Scalar(x + i, n - i, inverseScale, zeroPoint, q + i);
+}
+
+KERNELS_AVX2 static void quantizeInt8AVX2(const float* x, size_t n, float inverseScale, int32_t zeroPoint, int8_t* q)
+{
+    __m256 inverse = _mm256_set1_ps(inverseScale);
+    __m256 zero = _mm256_set1_ps((float)zeroPoint);
+    __m256 hiLimit = _mm256_set1_ps(127.0f);
+    __m256 loLimit = _mm256_set1_ps(-127.0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), inverse, zero);
+        __m256 b = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), inverse, zero);
+        a = _mm256_min_ps(hiLimit, _mm256_max_ps(loLimit, a));
+        b = _mm256_min_ps(hiLimit, _mm256_max_ps(loLimit, b));
+        // * packs works per 128-bit lane, the permute puts the 16 int16 back in order
+        __m256i words = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        words = _mm256_permute4x64_epi64(words, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i bytes = _mm_packs_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(q + i), bytes);
+    }
+    // * the tail is a tail call into SSE code, clear the upper halves to avoid the transition penalty
+    _mm256_zeroupper();
+    quantizeInt8Scalar(x + i, n - i, inverseScale, zeroPoint, q + i);
+}
+
+KERNELS_AVX2 static int32_t dotInt8AVX2(const int8_t* a, const int8_t* b, size_t n)
+{
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i alo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(va));
+        __m256i ahi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(va, 1));
+        __m256i blo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(vb));
+        __m256i bhi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(vb, 1));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(alo, blo));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(ahi, bhi));
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m256i alo = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i blo = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(alo, blo));
+    }
+    acc0 = _mm256_add_epi32(acc0, acc1);
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc0), _mm256_extracti128_si256(acc0, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum) + dotInt8Scalar(a + i, b + i, n - i);
+}
+#endif // KERNELS_X86
+
+#if defined(KERNELS_NEON)
+static int32_t dotInt8NEON(const int8_t* a, const int8_t* b, size_t n)
+{
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t va = vld1q_s8(a + i);
+        int8x16_t vb = vld1q_s8(b + i);
+        // * two products of [-127, 127] values still fit in an int16 lane
+        int16x8_t products = vmull_s8(vget_low_s8(va), vget_low_s8(vb));
+        products = vmlal_s8(products, vget_high_s8(va), vget_high_s8(vb));
+        acc = vpadalq_s16(acc, products);
+    }
+    return vaddvq_s32(acc) + dotInt8Scalar(a + i, b + i, n - i);
+}
+
+static void quantizeInt8NEON(const float* x, size_t n, float inverseScale, int32_t zeroPoint, int8_t* q)
+{
+    float32x4_t inverse = vdupq_n_f32(inverseScale);
+    float32x4_t zero = vdupq_n_f32((float)zeroPoint);
+    float32x4_t hiLimit = vdupq_n_f32(127.0f);
+    float32x4_t loLimit = vdupq_n_f32(-127.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vminq_f32(hiLimit, vmaxq_f32(loLimit, vmlaq_f32(zero, vld1q_f32(x + i), inverse)));
+        float32x4_t b = vminq_f32(hiLimit, vmaxq_f32(loLimit, vmlaq_f32(zero, vld1q_f32(x + i + 4), inverse)));
+        int16x8_t words = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b)));
+        vst1_s8(q + i, vqmovn_s16(words));
+    }
+    quantizeInt8Scalar(x + i, n - i, inverseScale, zeroPoint, q + i);
+}
+#endif // KERNELS_NEON
+
+/**
+ * @brief Picks the best int8 implementation for this CPU.
+ */
+static Int8KernelTable selectInt8Table()
+{
+    const char* forced = getenv("EDGEFRONTIER_KERNELS");
+    if (forced != nullptr && strcmp(forced, "scalar") == 0) {
+        return { "scalar", &dotInt8Scalar, &quantizeInt8Scalar };
+    }
+
+#if defined(KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && !(forced != nullptr && strcmp(forced, "sse2") == 0)) {
+        return { "avx2", &dotInt8AVX2, &quantizeInt8AVX2 };
+    }
+    return { "sse2", &dotInt8SSE2, &quantizeInt8SSE2 };
+#elif defined(KERNELS_NEON)
+    return { "neon", &dotInt8NEON, &quantizeInt8NEON };
+#else
+    return { "scalar", &dotInt8Scalar, &quantizeInt8Scalar };
+#endif
+}
+
+static const Int8KernelTable& int8Table()
+{
+    static const Int8KernelTable active = selectInt8Table();
+    return active;
+}
+
+/**
+ * @brief Dot product of two int8 arrays, accumulated in int32.
+ *
+ * @param a Pointer to n values in [-127, 127].
+ * @param b Pointer to n values in [-127, 127].
+ * @param n The number of values.
+ * @return The sum of a[i] * b[i].
+ */
+int32_t KernelsInt8::dot(const int8_t* a, const int8_t* b, size_t n)
+{
+    return int8Table().dot(a, b, n);
+}
+
+/**
+ * @brief Quantizes n floats to int8, x[i] ~ scale * (q[i] - zeroPoint).
+ *
+ * Values are rounded to nearest even and saturated to [-127, 127].
+ *
+ * @param x Pointer to n values.
+ * @param n The number of values.
+ * @param inverseScale 1 / scale, the value of one int8 step is scale.
+ * @param zeroPoint The int8 value that represents 0.
+ * @param q Receives n values in [-127, 127].
+ */
+void KernelsInt8::quantize(const float* x, size_t n, float inverseScale, int32_t zeroPoint, int8_t* q)
+{
+    int8Table().quantize(x, n, inverseScale, zeroPoint, q);
+}
+
+/**
+ * @brief Returns the name of the selected int8 implementation.
+ */
+const char* KernelsInt8::backend()
+{
+    return int8Table().name;
+}
+
+// ----------------------------------------------------
+// * Half precision
+// ----------------------------------------------------
+
+/**
+ * @brief Function table for one implementation of the half precision kernels.
+ */
+struct HalfKernelTable
+{
+    const char* name;
+    float (*dot[2])(const uint16_t*, const float*, size_t);    // * indexed by HalfFormat
+    void (*widen[2])(const uint16_t*, size_t, float*);
+};
+
+static inline float bitsToFloat(uint32_t bits)
+{
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static inline uint32_t floatToBits(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static inline float fp16ToFloat(uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x3FF;
+    if (exponent == 0x1F) {
+        return bitsToFloat(sign | 0x7F800000 | (mantissa << 13)); // * inf, nan
+    }
+    if (exponent == 0) {
+        // * zero or subnormal, mantissa * 2^-24
+        return bitsToFloat(sign | floatToBits((float)mantissa * 5.9604644775390625e-8f));
+    }
+    return bitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+static inline uint16_t floatToFp16(float f)
+{
+    uint32_t bits = floatToBits(f);
+    uint16_t sign = (bits >> 16) & 0x8000;
+    uint32_t a = bits & 0x7FFFFFFF;
+    if (a >= 0x7F800000) {
+        return sign | 0x7C00 | (a > 0x7F800000 ? 0x200 : 0); // * inf, quiet nan
+    }
+    if (a >= 0x477FF000) {
+        return sign | 0x7C00; // * 65520 and above round to inf
+    }
+    if (a < 0x38800000) {
+        // * below 2^-14, subnormal: round |f| / 2^-24 to nearest even
+        return sign | (uint16_t)std::nearbyint(bitsToFloat(a) * 16777216.0f);
+    }
+    // * rebias the exponent (127 -> 15) and round the mantissa to 10 bits, nearest even
+    uint32_t rounded = a + 0xFFF + ((a >> 13) & 1);
+    return sign | (uint16_t)((rounded - (112u << 23)) >> 13);
+}
+
+static inline float bf16ToFloat(uint16_t h)
+{
+    return bitsToFloat((uint32_t)h << 16);
+}
+
+static inline uint16_t floatToBf16(float f)
+{
+    uint32_t bits = floatToBits(f);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return (uint16_t)((bits >> 16) | 0x40); // * quiet nan
+    }
+    return (uint16_t)((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+}
+
+static float dotFP16Scalar(const uint16_t* w, const float* x, size_t n)
+{
+    float total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += fp16ToFloat(w[i]) * x[i];
+    }
+    return total;
+}
+
+static float dotBF16Scalar(const uint16_t* w, const float* x, size_t n)
+{
+    float total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += bf16ToFloat(w[i]) * x[i];
+    }
+    return total;
+}
+
+static void widenFP16Scalar(const uint16_t* h, size_t n, float* x)
+{
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = fp16ToFloat(h[i]);
+    }
+}
+
+static void widenBF16Scalar(const uint16_t* h, size_t n, float* x)
+{
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = bf16ToFloat(h[i]);
+    }
+}
+
+#if defined(KERNELS_X86)
+KERNELS_F16C static inline __m256 loadFP16(const uint16_t* h)
+{
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h)));
+}
+
+KERNELS_F16C static inline __m256 loadBF16(const uint16_t* h)
+{
+    __m256i words = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h)));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(words, 16));
+}
+
+KERNELS_F16C static inline float hsum_avx(__m256 v)
+{
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+KERNELS_F16C static inline __m128 loadFP16x4(const uint16_t* h)
+{
+    return _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(h)));
+}
+
+KERNELS_F16C static inline __m128 loadBF16x4(const uint16_t* h)
+{
+    return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(h))));
+}
+
+KERNELS_F16C static inline float scalarFP16(uint16_t h)
+{
+    return _cvtsh_ss(h);
+}
+
+// * short rows (the first layer of a small model) are common, so the tail takes one
+// * 4-wide step before going scalar
+#define HALF_DOT_F16C(NAME, LOAD8, LOAD4, SCALAR)                                       \
+KERNELS_F16C static float NAME(const uint16_t* w, const float* x, size_t n)            \
+{                                                                                       \
+    __m256 acc0 = _mm256_setzero_ps();                                                  \
+    __m256 acc1 = _mm256_setzero_ps();                                                  \
+    size_t i = 0;                                                                       \
+    for (; i + 16 <= n; i += 16) {                                                      \
+        acc0 = _mm256_fmadd_ps(LOAD8(w + i), _mm256_loadu_ps(x + i), acc0);             \
+        acc1 = _mm256_fmadd_ps(LOAD8(w + i + 8), _mm256_loadu_ps(x + i + 8), acc1);     \
+    }                                                                                   \
+    for (; i + 8 <= n; i += 8) {                                                        \
+        acc0 = _mm256_fmadd_ps(LOAD8(w + i), _mm256_loadu_ps(x + i), acc0);             \
+    }                                                                                   \
+    float total = hsum_avx(_mm256_add_ps(acc0, acc1));                                  \
+    if (i + 4 <= n) {                                                                   \
+        total += hsum_sse2(_mm_mul_ps(LOAD4(w + i), _mm_loadu_ps(x + i)));              \
+        i += 4;                                                                         \
+    }                                                                                   \
+    for (; i < n; ++i) {                                                                \
+        total += SCALAR(w[i]) * x[i];                                                   \
+    }                                                                                   \
+    return total;                                                                       \
+}
+
+HALF_DOT_F16C(dotFP16F16C, loadFP16, loadFP16x4, scalarFP16)
+HALF_DOT_F16C(dotBF16F16C, loadBF16, loadBF16x4, bf16ToFloat)
+
+KERNELS_F16C static void widenFP16F16C(const uint16_t* h, size_t n, float* x)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(x + i, loadFP16(h + i));
+    }
+    for (; i < n; ++i) {
+        x[i] = scalarFP16(h[i]);
+    }
+}
+
+KERNELS_F16C static void widenBF16F16C(const uint16_t* h, size_t n, float* x)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(x + i, loadBF16(h + i));
+    }
+    for (; i < n; ++i) {
+        x[i] = bf16ToFloat(h[i]);
+    }
+}
+#endif // KERNELS_X86
+
+#if defined(KERNELS_NEON)
+// * aarch64 converts fp16 natively, bf16 is the upper half of a float so a shift widens it
+#define HALF_DOT_NEON(NAME, WIDEN_LO, WIDEN_HI, WIDEN4, SCALAR)                         \
+static float NAME(const uint16_t* w, const float* x, size_t n)                          \
+{                                                                                       \
+    float32x4_t acc0 = vdupq_n_f32(0.0f);                                               \
+    float32x4_t acc1 = vdupq_n_f32(0.0f);                                               \
+    size_t i = 0;                                                                       \
+    for (; i + 8 <= n; i += 8) {                                                        \
+        uint16x8_t h = vld1q_u16(w + i);                                                \
+        acc0 = vfmaq_f32(acc0, WIDEN_LO(h), vld1q_f32(x + i));                          \
+        acc1 = vfmaq_f32(acc1, WIDEN_HI(h), vld1q_f32(x + i + 4));                      \
+    }                                                                                   \
+    if (i + 4 <= n) {                                                                   \
+        acc0 = vfmaq_f32(acc0, WIDEN4(vld1_u16(w + i)), vld1q_f32(x + i));              \
+        i += 4;                                                                         \
+    }                                                                                   \
+    float total = vaddvq_f32(vaddq_f32(acc0, acc1));                                    \
+    for (; i < n; ++i) {                                                                \
+        total += SCALAR(w[i]) * x[i];                                                   \
+    }                                                                                   \
+    return total;                                                                       \
+}
+
+static inline float32x4_t widenFP16Low(uint16x8_t h)
+{
+    return vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(h)));
+}
+
+static inline float32x4_t widenFP16High(uint16x8_t h)
+{
+    return vcvt_high_f32_f16(vreinterpretq_f16_u16(h));
+}
+
+static inline float32x4_t widenBF16Low(uint16x8_t h)
+{
+    return vreinterpretq_f32_u32(vshll_n_u16(vget_low_u16(h), 16));
+}
+
+static inline float32x4_t widenBF16High(uint16x8_t h)
+{
+    return vreinterpretq_f32_u32(vshll_high_n_u16(h, 16));
+}
+
+static inline float32x4_t widenFP16x4(uint16x4_t h)
+{
+    return vcvt_f32_f16(vreinterpret_f16_u16(h));
+}
+
+static inline float32x4_t widenBF16x4(uint16x4_t h)
+{
+    return vreinterpretq_f32_u32(vshll_n_u16(h, 16));
+}
+
+HALF_DOT_NEON(dotFP16NEON, widenFP16Low, widenFP16High, widenFP16x4, fp16ToFloat)
+HALF_DOT_NEON(dotBF16NEON, widenBF16Low, widenBF16High, widenBF16x4, bf16ToFloat)
+
+static void widenFP16NEON(const uint16_t* h, size_t n, float* x)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t v = vld1q_u16(h + i);
+        vst1q_f32(x + i, widenFP16Low(v));
+        vst1q_f32(x + i + 4, widenFP16High(v));
+    }
+    widenFP16Scalar(h + i, n - i, x + i);
+}
+
+static void widenBF16NEON(const uint16_t* h, size_t n, float* x)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t v = vld1q_u16(h + i);
+        vst1q_f32(x + i, widenBF16Low(v));
+        vst1q_f32(x + i + 4, widenBF16High(v));
+    }
+    widenBF16Scalar(h + i, n - i, x + i);
+}
+#endif // KERNELS_NEON
+
+/**
+ * @brief Picks the best half precision implementation for this CPU.
+ */
+static HalfKernelTable selectHalfTable()
+{
+    const HalfKernelTable scalar = { "scalar", { &dotFP16Scalar, &dotBF16Scalar }, { &widenFP16Scalar, &widenBF16Scalar } };
+    const char* forced = getenv("EDGEFRONTIER_KERNELS");
+    if (forced != nullptr && strcmp(forced, "scalar") == 0) {
+        return scalar;
+    }
+
+#if defined(KERNELS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c") && __builtin_cpu_supports("fma") &&
+        !(forced != nullptr && strcmp(forced, "sse2") == 0)) {
+        return { "f16c", { &dotFP16F16C, &dotBF16F16C }, { &widenFP16F16C, &widenBF16F16C } };
+    }
+    return scalar;
+#elif defined(KERNELS_NEON)
+    return { "neon", { &dotFP16NEON, &dotBF16NEON }, { &widenFP16NEON, &widenBF16NEON } };
+#else
+    return scalar;
+#endif
+}
+
+static const HalfKernelTable& halfTable()
+{
+    static const HalfKernelTable active = selectHalfTable();
+    return active;
+}
+
+/**
+ * @brief Dot product of half precision weights with float inputs, accumulated in float.
+ *
+ * @param format The storage format of w.
+ * @param w Pointer to n half precision values.
+ * @param x Pointer to n values.
+ * @param n The number of values.
+ * @return The sum of widen(w[i]) * x[i].
+ */
+float KernelsHalf::dot(HalfFormat format, const uint16_t* w, const float* x, size_t n)
+{
+    return halfTable().dot[format](w, x, n);
+}
+
+/**
+ * @brief Converts n half precision values to float, exactly.
+ *
+ * @param format The storage format of h.
+ * @param h Pointer to n half precision values.
+ * @param n The number of values.
+ * @param x Receives n values.
+ */
+void KernelsHalf::widen(HalfFormat format, const uint16_t* h, size_t n, float* x)
+{
+    halfTable().widen[format](h, n, x);
+}
+
+/**
+ * @brief Rounds n floats to half precision, nearest even.
+ *
+ * Used once when a model is converted, so it is not vectorized. fp16 saturates to
+ * inf beyond +-65504 and keeps subnormals; bf16 keeps the float range.
+ *
+ * @param format The storage format of h.
+ * @param x Pointer to n values.
+ * @param n The number of values.
+ * @param h Receives n half precision values.
+ */
+void KernelsHalf::narrow(HalfFormat format, const float* x, size_t n, uint16_t* h)
+{
+    for (size_t i = 0; i < n; ++i) {
+        h[i] = (format == HALF_FP16) ? floatToFp16(x[i]) : floatToBf16(x[i]);
+    }
+}
+
+/**
+ * @brief Returns the name of the selected half precision implementation.
+ */
+const char* KernelsHalf::backend()
+{
+    return halfTable().name;
+}
+
+// Explicitly instantiate the template for the types you need
+template struct Kernels<float>;
+template struct Kernels<double>;
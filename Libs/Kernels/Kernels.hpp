@@ -0,0 +1,92 @@
+// ****************************************************
+// * Code by Kidsadakorn Nuallaoong
+// * Neural Network - Kernels
+// * Vectorized dot product and activation kernels
+// ****************************************************
+
+#if !defined(KERNELS_H)
+#define KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "../Activation/Activation.hpp"
+
+using namespace std;
+
+/**
+ * @brief SIMD kernels used on the inference hot path.
+ *
+ * The implementation (AVX2+FMA or SSE2 on x86_64, NEON on aarch64, scalar
+ * otherwise) is picked once at first use by CPU feature detection. Set the
+ * environment variable EDGEFRONTIER_KERNELS=scalar to force the fallback.
+ *
+ * The vectorized sigmoid/tanh use a polynomial exp approximation
+ * (about 1 ulp for float, a few ulp for double). activate() can instead use the
+ * rational or table approximations selected by ActivationPrecision.
+ *
+ * @tparam T The data type (float or double).
+ */
+template <typename T>
+struct Kernels
+{
+    static T dot(const T* a, const T* b, size_t n);
+    static void dot4(const T* w, const T* x, size_t stride, size_t n, T* out);
+
+    static void sigmoid(T* x, size_t n);
+    static void tanh(T* x, size_t n);
+    static void relu(T* x, size_t n);
+    static void leakyrelu(T* x, size_t n);
+    static void softmax(T* x, size_t n);
+
+    // * in-place activation of n values
+    static void activate(ActivationType type, T* x, size_t n, ActivationPrecision precision = PRECISION_EXACT);
+
+    // * name of the selected implementation ("avx2", "sse2", "neon" or "scalar")
+    static const char* backend();
+};
+
+/**
+ * @brief Integer kernels of the int8 quantized inference path (see QuantizedNetwork).
+ *
+ * Dispatched like Kernels: AVX2 or SSE2 on x86_64, NEON on aarch64, scalar otherwise,
+ * EDGEFRONTIER_KERNELS=scalar forces the fallback. Operands must be in [-127, 127];
+ * products are summed in int32, which is exact for any realistic row length.
+ */
+struct KernelsInt8
+{
+    static int32_t dot(const int8_t* a, const int8_t* b, size_t n);
+
+    // * q[i] = round(x[i] * inverseScale) + zeroPoint, clamped to [-127, 127]
+    static void quantize(const float* x, size_t n, float inverseScale, int32_t zeroPoint, int8_t* q);
+
+    // * name of the selected implementation ("avx2", "sse2", "neon" or "scalar")
+    static const char* backend();
+};
+
+/**
+ * @brief Storage formats of half precision weights (see HalfNetwork).
+ */
+enum HalfFormat {
+    HALF_FP16 = 0,  // * IEEE 754 binary16: 10-bit mantissa, range +-65504
+    HALF_BF16 = 1   // * bfloat16: 7-bit mantissa, same range as float
+};
+
+/**
+ * @brief Kernels of the half precision weight path: weights are stored in 16 bits and
+ * widened to float in registers, products are accumulated in float.
+ *
+ * Dispatched like Kernels: AVX2+F16C on x86_64, native fp16 conversion on aarch64,
+ * scalar otherwise; EDGEFRONTIER_KERNELS=scalar forces the fallback.
+ */
+struct KernelsHalf
+{
+    static float dot(HalfFormat format, const uint16_t* w, const float* x, size_t n);
+
+    static void widen(HalfFormat format, const uint16_t* h, size_t n, float* x);
+    static void narrow(HalfFormat format, const float* x, size_t n, uint16_t* h);
+
+    // * name of the selected implementation ("f16c", "neon" or "scalar")
+    static const char* backend();
+};
+
+#endif // KERNELS_H
@@ -11,9 +11,13 @@
  */
 
 #include "Perceptron.hpp"
+#include "../Kernels/Kernels.hpp"
 #include <cmath>
 #include <string>
 #include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 
 using namespace std;
 using std::vector;
@@ -29,7 +33,7 @@ Perceptron<T>::Perceptron()
     // * Constructor
     this->bias = 0;
     this->output = 0;
-    this->activationType = "sigmoid";
+    typeActivation(SIGMOID);
 }
 
 /**
@@ -43,25 +47,6 @@ Perceptron<T>::Perceptron(int inputSize)
     init(inputSize);
 }
 
-/**
- * @brief Destructor for the Perceptron class.
- * 
- * Frees any allocated memory and resets the perceptron state.
- */
-template <typename T>
-Perceptron<T>::~Perceptron()
-{
-    // * Destructor
-    // * Free memory
-    weights.clear();
-    weights.shrink_to_fit();
-
-    // * Reset bias
-    bias = 0;
-    output = 0;
-    activationType = "sigmoid";
-}
-
 /**
  * @brief Initializes the perceptron with random weights and bias.
  * 
@@ -87,6 +72,20 @@ void Perceptron<T>::setWeights(const vector<T>& weights) {
     this->weights = weights;
 }
 
+/**
+ * @brief Sets the weights of the perceptron from n contiguous values.
+ * 
+ * Does not allocate when n matches the current number of weights.
+ * 
+ * @param weights Pointer to n values.
+ * @param n The number of weights.
+ */
+template <typename T>
+void Perceptron<T>::setWeights(const T* weights, size_t n)
+{
+    this->weights.assign(weights, weights + n);
+}
+
 /**
  * @brief Sets a specific weight of the perceptron.
  * 
@@ -125,6 +124,8 @@ void Perceptron<T>::resetWeightsBias()
 /**
  * @brief Returns the current weights of the perceptron.
  * 
+ * Allocates a copy, use weightSpan() to read the weights in place.
+ * 
  * @return A vector containing the current weights.
  */
 template <typename T>
@@ -144,33 +145,73 @@ T Perceptron<T>::_bias()
     return T(this->bias);
 }
 
+/**
+ * @brief Returns a read-only view of the weights, without copying.
+ * 
+ * @return A view valid until the weights are resized.
+ */
+template <typename T>
+Span<const T> Perceptron<T>::weightSpan() const
+{
+    return Span<const T>(weights.data(), weights.size());
+}
+
+/**
+ * @brief Returns a writable view of the weights, without copying.
+ * 
+ * @return A view valid until the weights are resized.
+ */
+template <typename T>
+Span<T> Perceptron<T>::weightSpan()
+{
+    return Span<T>(weights.data(), weights.size());
+}
+
 /**
  * @brief Sets the activation function type for the perceptron.
  * 
+ * Thin layer over typeActivation(ActivationType): the name is parsed once here so
+ * that activation() never compares strings.
+ * 
  * @param type The activation function type (e.g., "linear", "sigmoid", "tanh", "relu", "leakyrelu", "softmax", "step").
  */
 template <typename T>
 void Perceptron<T>::typeActivation(string type)
 {
-    // * change type to lower case
-    for (int i = 0; i < type.length(); i++)
-    {
-        type[i] = tolower(type[i]);
-    }
-
-    if (!(type == "linear" || 
-          type == "sigmoid" ||
-          type == "tanh" ||
-          type == "relu" ||
-          type == "leakyrelu" ||
-          type == "softmax" ||
-          type == "step"))
+    ActivationType kind;
+    if (!parseActivation(type, kind))
     {
         cerr << "\033[1;31mActivation Type Not Found\033[0m" << endl;
         return;
     }
 
-    this->activationType = type;
+    typeActivation(kind);
+}
+
+/**
+ * @brief Sets the activation function type for the perceptron.
+ * 
+ * Resolves the activation function once, feedForward then calls it without branching on the type.
+ * 
+ * @param type The activation function type.
+ */
+template <typename T>
+void Perceptron<T>::typeActivation(ActivationType type)
+{
+    this->activationFn = Activation<T>::resolve(type, activationPrecision);
+    this->activationKind = type;
+}
+
+/**
+ * @brief Selects how sigmoid and tanh are evaluated, see ActivationPrecision.
+ * 
+ * @param precision Exact, rational or table.
+ */
+template <typename T>
+void Perceptron<T>::setActivationPrecision(ActivationPrecision precision)
+{
+    this->activationPrecision = precision;
+    this->activationFn = Activation<T>::resolve(activationKind, precision);
 }
 
 /**
@@ -180,27 +221,8 @@ void Perceptron<T>::typeActivation(string type)
  * @return The output value after applying the activation function.
  */
 template <typename T>
-T Perceptron<T>::activation(T x) {
-    if (activationType == "linear") {
-        return x;
-    } else if (activationType == "sigmoid") {
-        return 1 / (1 + exp(-x));
-    } else if (activationType == "tanh") {
-        return tanh(x);
-    } else if (activationType == "relu") {
-        return (x > 0) ? x : 0;
-    } else if (activationType == "leakyrelu") {
-        return (x > 0) ? x : 0.01 * x;
-    } else if (activationType == "softmax") {
-        // Softmax is not applicable here for scalar values.
-        std::cerr << "\033[1;31mSoftmax must be computed over a vector, not a scalar.\033[0m" << std::endl;
-        throw std::invalid_argument("Softmax must be computed over a vector.");
-    } else if (activationType == "step") {
-        return (x > 0) ? 1 : 0;
-    } else {
-        std::cerr << "\033[1;31mActivation Type Not Found\033[0m" << std::endl;
-        throw std::invalid_argument("Activation Type Not Found");
-    }
+T Perceptron<T>::activation(T x) const {
+    return activationFn(x);
 }
 
 /**
@@ -212,13 +234,7 @@ T Perceptron<T>::activation(T x) {
 template <typename T>
 T Perceptron<T>::feedForward(const vector<T>& inputs)
 {
-    T total = bias;
-    for (int i = 0; i < weights.size(); ++i) {
-        total += weights[i] * inputs[i];
-    }
-
-    output = activation(total);
-    return T(output);
+    return feedForward(inputs.data(), inputs.size(), bias);
 }
 
 /**
@@ -231,15 +247,95 @@ T Perceptron<T>::feedForward(const vector<T>& inputs)
 template <typename T>
 T Perceptron<T>::feedForward(const vector<T>& inputs, T bias)
 {
-    T total = bias;
-    for (int i = 0; i < weights.size(); ++i) {
-        total += weights[i] * inputs[i];
-    }
+    return feedForward(inputs.data(), inputs.size(), bias);
+}
+
+/**
+ * @brief Feeds n contiguous input values through the perceptron, without allocating.
+ * 
+ * @param inputs Pointer to n values, n must be at least the number of weights.
+ * @param n The number of input values.
+ * @return The output value after applying the perceptron.
+ */
+template <typename T>
+T Perceptron<T>::feedForward(const T* inputs, size_t n)
+{
+    return feedForward(inputs, n, bias);
+}
 
-    output = activation(total);
+/**
+ * @brief Feeds n contiguous input values through the perceptron with a specified bias.
+ * 
+ * @param inputs Pointer to n values, n must be at least the number of weights.
+ * @param n The number of input values.
+ * @param bias The bias value to use.
+ * @return The output value after applying the perceptron.
+ */
+template <typename T>
+T Perceptron<T>::feedForward(const T* inputs, size_t n, T bias)
+{
+    output = predict(inputs, n, bias);
     return T(output);
 }
 
+/**
+ * @brief Feeds a view of input values through the perceptron, without allocating.
+ * 
+ * @param inputs At least as many values as weights.
+ * @return The output value after applying the perceptron.
+ */
+template <typename T>
+T Perceptron<T>::feedForward(Span<const T> inputs)
+{
+    return feedForward(inputs.data(), inputs.size(), bias);
+}
+
+/**
+ * @brief Computes the output for n contiguous input values without modifying the perceptron.
+ * 
+ * Unlike feedForward, output is left untouched, so concurrent calls on one perceptron are safe.
+ * 
+ * @param inputs Pointer to n values, n must be at least the number of weights.
+ * @param n The number of input values.
+ * @return The output value after applying the perceptron.
+ */
+template <typename T>
+T Perceptron<T>::predict(const T* inputs, size_t n) const
+{
+    return predict(inputs, n, bias);
+}
+
+/**
+ * @brief Computes the output with a specified bias without modifying the perceptron.
+ * 
+ * @param inputs Pointer to n values, n must be at least the number of weights.
+ * @param n The number of input values.
+ * @param bias The bias value to use.
+ * @return The output value after applying the perceptron.
+ */
+template <typename T>
+T Perceptron<T>::predict(const T* inputs, size_t n, T bias) const
+{
+    if (n < weights.size()) {
+        std::cerr << "\033[1;31mPerceptron input size mismatch\033[0m" << std::endl;
+        throw std::invalid_argument("Perceptron input size mismatch");
+    }
+
+    return activation(bias + Kernels<T>::dot(weights.data(), inputs, weights.size()));
+}
+
+/**
+ * @brief Computes the output for a view of input values without modifying the perceptron.
+ * 
+ * @param inputs At least as many values as weights.
+ * @return The output value after applying the perceptron.
+ */
+template <typename T>
+T Perceptron<T>::predict(Span<const T> inputs) const
+{
+    return predict(inputs.data(), inputs.size(), bias);
+}
+
 /**
  * @brief Trains the perceptron using the given inputs and target output.
  * 
@@ -249,16 +345,46 @@ T Perceptron<T>::feedForward(const vector<T>& inputs, T bias)
  */
 template <typename T>
 void Perceptron<T>::train(const vector<T>& inputs, T target, const T learningRate) {
-    T error = target - feedForward(inputs);
-    for (int i = 0; i < weights.size(); ++i) {
-        weights[i] += learningRate * error * inputs[i];
+    train(inputs.data(), inputs.size(), target, learningRate);
+}
+
+/**
+ * @brief Trains the perceptron on n contiguous input values, without allocating.
+ * 
+ * @param inputs Pointer to n values, n must be at least the number of weights.
+ * @param n The number of input values.
+ * @param target The target output value.
+ * @param learningRate The learning rate for the training.
+ */
+template <typename T>
+void Perceptron<T>::train(const T* inputs, size_t n, const T target, const T learningRate)
+{
+    T step = learningRate * (target - feedForward(inputs, n, bias));
+    T* w = weights.data();
+    for (size_t i = 0; i < weights.size(); ++i) {
+        w[i] += step * inputs[i];
     }
-    bias += learningRate * error;
+    bias += step;
+}
+
+/**
+ * @brief Trains the perceptron on a view of input values, without allocating.
+ * 
+ * @param inputs At least as many values as weights.
+ * @param target The target output value.
+ * @param learningRate The learning rate for the training.
+ */
+template <typename T>
+void Perceptron<T>::train(Span<const T> inputs, const T target, const T learningRate)
+{
+    train(inputs.data(), inputs.size(), target, learningRate);
 }
 
 /**
  * @brief Returns the current weights of the perceptron.
  * 
+ * Allocates a copy, use weightSpan() to read the weights in place.
+ * 
  * @return A vector containing the current weights.
  */
 template <typename T>
@@ -300,6 +426,35 @@ T Perceptron<T>::getOutput()
     return T(this->output);
 }
 
+/**
+ * @brief Returns the name of the activation function, derived from the resolved type.
+ * 
+ * @return The lower-case activation name (e.g., "sigmoid").
+ */
+template <typename T>
+string Perceptron<T>::getActivationType() const
+{
+    return activationName(activationKind);
+}
+
+/**
+ * @brief Returns the activation function type used by feedForward and predict.
+ */
+template <typename T>
+ActivationType Perceptron<T>::getActivationKind() const
+{
+    return activationKind;
+}
+
+/**
+ * @brief Returns how sigmoid and tanh are evaluated, see ActivationPrecision.
+ */
+template <typename T>
+ActivationPrecision Perceptron<T>::getActivationPrecision() const
+{
+    return activationPrecision;
+}
+
 /**
  * @brief Displays the current state of the perceptron.
  */
@@ -314,10 +469,14 @@ void Perceptron<T>::display()
     }
     cout << endl;
     cout << "\033[1;33mBias:\033[0m " << bias << endl;
-    cout << "\033[1;33mActivation Type:\033[0m " << activationType << endl;
+    cout << "\033[1;33mActivation Type:\033[0m " << getActivationType() << endl;
     cout << "\033[1;33mOutput:\033[0m " << output << endl;
 }
 
+// * vector<Perceptron> relies on this to move neurons instead of copying their weights on reallocation
+static_assert(std::is_nothrow_move_constructible<Perceptron<float>>::value, "Perceptron must be nothrow movable");
+static_assert(std::is_nothrow_move_constructible<Perceptron<double>>::value, "Perceptron must be nothrow movable");
+
 // Explicitly instantiate the template for the types you need
 template class Perceptron<float>;
 template class Perceptron<double>;
\ No newline at end of file
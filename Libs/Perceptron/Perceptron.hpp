@@ -9,9 +9,22 @@
 
 #include <vector>
 #include <iostream>
+#include "../Activation/Activation.hpp"
+#include "../Span/Span.hpp"
 
 using namespace std;
 
+/**
+ * @brief A single neuron: weights, bias and an activation resolved once.
+ *
+ * The pointer / Span overloads of feedForward, train and setWeights never allocate,
+ * and weightSpan() exposes the weights without copying, so once the weights are sized
+ * the inference and training paths run without touching the heap. Perceptron is cheap
+ * to move (vector<Perceptron> reallocation moves the weight vectors instead of copying them).
+ *
+ * feedForward stores its result in output; predict is the const, reentrant equivalent
+ * that only reads the neuron, so several threads can evaluate one shared Perceptron.
+ */
 template <typename T>
 class Perceptron
 {
@@ -20,16 +33,19 @@ class Perceptron
         T bias = 1;
         T output = 0;
 
-        string activationType = "linear";
-
     public:
         Perceptron();
         Perceptron(int inputSize);
-        ~Perceptron();
+
+        Perceptron(const Perceptron& other) = default;
+        Perceptron(Perceptron&& other) noexcept = default;
+        Perceptron& operator=(const Perceptron& other) = default;
+        Perceptron& operator=(Perceptron&& other) noexcept = default;
 
         void init(int inputSize);
 
         void setWeights(const vector<T>& weights);
+        void setWeights(const T* weights, size_t n);
         void setWeights(const int index, const T weight);
         void setBias(const T bias);
         
@@ -38,21 +54,45 @@ class Perceptron
         vector<T> _weights();
         T _bias();
 
-         void typeActivation(string type);
-        T activation(T x);
+        Span<const T> weightSpan() const;
+        Span<T> weightSpan();
+
+        void typeActivation(string type);
+        void typeActivation(ActivationType type);
+        void setActivationPrecision(ActivationPrecision precision);
+        T activation(T x) const;
 
         T feedForward(const vector<T>& inputs);
         T feedForward(const vector<T>& inputs, T bias);
+        T feedForward(const T* inputs, size_t n);
+        T feedForward(const T* inputs, size_t n, T bias);
+        T feedForward(Span<const T> inputs);
+
+        T predict(const T* inputs, size_t n) const;
+        T predict(const T* inputs, size_t n, T bias) const;
+        T predict(Span<const T> inputs) const;
 
         void train(const vector<T>& inputs,const T target, const T learningRate);
+        void train(const T* inputs, size_t n, const T target, const T learningRate);
+        void train(Span<const T> inputs, const T target, const T learningRate);
 
         vector<T> getWeights();
         T getBias();
         T getOutput();
 
+        string getActivationType() const;
+        ActivationType getActivationKind() const;
+        ActivationPrecision getActivationPrecision() const;
+
         Perceptron<T> cpyEnv() const;
 
         void display();
+
+    private:
+        // * only changed through typeActivation / setActivationPrecision, so the resolved function always matches
+        ActivationType activationKind = LINEAR;
+        ActivationPrecision activationPrecision = PRECISION_EXACT;
+        typename Activation<T>::Function activationFn = &Activation<T>::linear;
 };
 
 #endif // PERCEPTRON_H
\ No newline at end of file
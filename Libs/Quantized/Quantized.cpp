@@ -0,0 +1,297 @@
+/**
+ * @file Quantized.cpp
+ * @brief Implementation of the QuantizedLayer and QuantizedNetwork classes.
+ *
+ * Post-training int8 quantization of a DenseNetwork: symmetric per-neuron weight scales,
+ * per-call affine input quantization, int32 accumulation on KernelsInt8 and float
+ * bias/activation.
+ */
+
+#include "Quantized.hpp"
+#include "../Kernels/Kernels.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+using std::vector;
+
+
+/**
+ * @brief Grows the buffers to fit a network, no-op once they do.
+ *
+ * @param widest Outputs of the widest layer.
+ * @param inputSize Inputs of the network.
+ * @param outputSize Outputs of the network.
+ */
+void EngineScratch::reserve(size_t widest, int inputSize, int outputSize)
+{
+    if (a.size() < widest) {
+        a.resize(widest);
+        b.resize(widest);
+    }
+    if (convertedInputs.size() < (size_t)inputSize || convertedOutputs.size() < (size_t)outputSize) {
+        convertedInputs.resize(std::max(convertedInputs.size(), (size_t)inputSize));
+        convertedOutputs.resize(std::max(convertedOutputs.size(), (size_t)outputSize));
+    }
+}
+
+/**
+ * @brief Default constructor for the QuantizedLayer class.
+ */
+QuantizedLayer::QuantizedLayer()
+{
+}
+
+/**
+ * @brief Quantizes the weights of a dense layer, one scale per neuron.
+ *
+ * @param layer The floating point layer.
+ */
+template <typename T>
+void QuantizedLayer::quantize(const DenseLayer<T>& layer)
+{
+    inputSize = layer.inputSize;
+    outputSize = layer.outputSize;
+    activationKind = layer.activationKind;
+    activationPrecision = layer.activationPrecision;
+    weights.resize((size_t)inputSize * outputSize);
+    scales.resize(outputSize);
+    rowSums.resize(outputSize);
+    bias.resize(outputSize);
+
+    const T* row = layer.weightData();
+    const T* b = layer.biasData();
+    for (int o = 0; o < outputSize; ++o, row += inputSize) {
+        double m = 0;
+        for (int i = 0; i < inputSize; ++i) {
+            m = std::max(m, std::fabs((double)row[i]));
+        }
+        // * an all-zero row keeps scale 1 so dequantization stays finite
+        double scale = m > 0 ? m / 127.0 : 1.0;
+        int8_t* q = weights.data() + (size_t)o * inputSize;
+        int32_t sum = 0;
+        for (int i = 0; i < inputSize; ++i) {
+            q[i] = (int8_t)std::min(127.0, std::max(-127.0, std::nearbyint(row[i] / scale)));
+            sum += q[i];
+        }
+        scales[o] = (float)scale;
+        rowSums[o] = sum;
+        bias[o] = (float)b[o];
+    }
+}
+
+/**
+ * @brief Evaluates the layer: outputs = activation(dequantize(Wq * quantize(inputs)) + bias).
+ *
+ * With inputs x ~ s * (q - z): W x ~ scales * s * (dot(Wq, q) - z * rowSums).
+ *
+ * @param inputs Pointer to inputSize values.
+ * @param quantizedInputs Scratch for inputSize int8 values.
+ * @param outputs Pointer to outputSize values, must not alias inputs.
+ */
+void QuantizedLayer::forward(const float* inputs, int8_t* quantizedInputs, float* outputs) const
+{
+    // * the range always spans 0, so the zero point stays within int8: inputs in a narrow
+    // * band far from 0 would otherwise need a zero point that overflows the int32 correction
+    float lo = 0;
+    float hi = 0;
+    if (inputSize > 0) {
+        auto range = std::minmax_element(inputs, inputs + inputSize);
+        lo = std::min(*range.first, 0.0f);
+        hi = std::max(*range.second, 0.0f);
+    }
+
+    if (lo == 0 && hi == 0) {
+        std::copy(bias.begin(), bias.end(), outputs);
+    } else {
+        // * lo maps to -127 and hi to 127, 0 to zeroPoint in [-127, 127]
+        float inputScale = (hi - lo) / 254.0f;
+        int32_t zeroPoint = (int32_t)std::nearbyint(-127.0f - lo / inputScale);
+        KernelsInt8::quantize(inputs, inputSize, 1.0f / inputScale, zeroPoint, quantizedInputs);
+
+        const int8_t* row = weights.data();
+        for (int o = 0; o < outputSize; ++o, row += inputSize) {
+            int32_t acc;
+            if (inputSize < 16) {
+                // * shorter than one vector, the dispatched kernel would only run its scalar tail
+                acc = 0;
+                for (int i = 0; i < inputSize; ++i) {
+                    acc += (int32_t)row[i] * quantizedInputs[i];
+                }
+            } else {
+                acc = KernelsInt8::dot(row, quantizedInputs, inputSize);
+            }
+            acc -= zeroPoint * rowSums[o];
+            outputs[o] = (float)acc * (scales[o] * inputScale) + bias[o];
+        }
+    }
+
+    Kernels<float>::activate(activationKind, outputs, outputSize, activationPrecision);
+}
+
+/**
+ * @brief Default constructor for the QuantizedNetwork class.
+ */
+QuantizedNetwork::QuantizedNetwork()
+{
+}
+
+/**
+ * @brief Builds the int8 network from a loaded floating point network.
+ *
+ * @param reference The network to quantize, left unchanged.
+ */
+template <typename T>
+void QuantizedNetwork::quantize(const DenseNetwork<T>& reference)
+{
+    clearModel();
+    layers.resize(reference.layers.size());
+    for (size_t l = 0; l < layers.size(); ++l) {
+        layers[l].quantize(reference.layers[l]);
+        widest = std::max(widest, (size_t)layers[l].outputSize);
+        widestInput = std::max(widestInput, (size_t)layers[l].inputSize);
+    }
+    reserve(scratch);
+}
+
+/**
+ * @brief Compares the int8 predictions with the reference network.
+ *
+ * @param reference The network this one was quantized from.
+ * @param calibration Representative inputs, one vector of inputSize() values per sample.
+ * @return The error statistics over every output of every sample.
+ */
+template <typename T>
+QuantizationReport QuantizedNetwork::evaluate(const DenseNetwork<T>& reference, const vector<vector<T>>& calibration) const
+{
+    Scratch scratch;
+    return compareWithReference("Quantized", reference, calibration, inputSize(), outputSize(),
+                                [&](const float* inputs, float* outputs) { predict(inputs, outputs, scratch); });
+}
+
+/**
+ * @brief Returns the number of inputs of the network.
+ */
+int QuantizedNetwork::inputSize() const
+{
+    return layers.empty() ? 0 : layers.front().inputSize;
+}
+
+/**
+ * @brief Returns the number of outputs of the network.
+ */
+int QuantizedNetwork::outputSize() const
+{
+    return layers.empty() ? 0 : layers.back().outputSize;
+}
+
+/**
+ * @brief Returns the memory taken by the weights, scales and biases.
+ */
+size_t QuantizedNetwork::weightBytes() const
+{
+    size_t total = 0;
+    for (const auto& layer : layers) {
+        total += layer.weights.size() * sizeof(int8_t) + (layer.scales.size() + layer.bias.size()) * sizeof(float) +
+                 layer.rowSums.size() * sizeof(int32_t);
+    }
+    return total;
+}
+
+/**
+ * @brief Predicts one sample without allocating.
+ *
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ */
+void QuantizedNetwork::predict(const float* inputs, float* outputs)
+{
+    predict(inputs, outputs, scratch);
+}
+
+/**
+ * @brief Predicts one sample given in double precision, without allocating.
+ *
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ */
+void QuantizedNetwork::predict(const double* inputs, double* outputs)
+{
+    predict(inputs, outputs, scratch);
+}
+
+/**
+ * @brief Predicts one sample without modifying the network.
+ *
+ * Reentrant: every intermediate value lives in the caller's scratch, which only
+ * allocates the first time it is used with this network.
+ *
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ * @param scratch Buffers owned by the calling thread.
+ */
+void QuantizedNetwork::predict(const float* inputs, float* outputs, Scratch& scratch) const
+{
+    if (layers.empty()) {
+        return;
+    }
+    reserve(scratch);
+
+    const float* current = inputs;
+    for (size_t l = 0; l + 1 < layers.size(); ++l) {
+        float* next = (l % 2 == 0) ? scratch.a.data() : scratch.b.data();
+        layers[l].forward(current, scratch.quantizedInputs.data(), next);
+        current = next;
+    }
+    layers.back().forward(current, scratch.quantizedInputs.data(), outputs);
+}
+
+/**
+ * @brief Predicts one sample given in double precision without modifying the network.
+ *
+ * @param inputs Pointer to inputSize() values.
+ * @param outputs Pointer to outputSize() values.
+ * @param scratch Buffers owned by the calling thread.
+ */
+void QuantizedNetwork::predict(const double* inputs, double* outputs, Scratch& scratch) const
+{
+    if (layers.empty()) {
+        return;
+    }
+    reserve(scratch);
+
+    predictConverted(scratch, inputs, outputs, inputSize(), outputSize(),
+                     [&](const float* in, float* out) { predict(in, out, scratch); });
+}
+
+/**
+ * @brief Grows the buffers of a scratch to fit this network, no-op once they do.
+ */
+void QuantizedNetwork::reserve(Scratch& scratch) const
+{
+    scratch.EngineScratch::reserve(widest, inputSize(), outputSize());
+    if (scratch.quantizedInputs.size() < widestInput) {
+        scratch.quantizedInputs.resize(widestInput);
+    }
+}
+
+/**
+ * @brief Removes every layer and frees the scratch buffers.
+ */
+void QuantizedNetwork::clearModel()
+{
+    layers.clear();
+    layers.shrink_to_fit();
+    scratch = Scratch();
+    widest = 0;
+    widestInput = 0;
+}
+
+// Explicitly instantiate the templates for the types you need
+template void QuantizedLayer::quantize<float>(const DenseLayer<float>&);
+template void QuantizedLayer::quantize<double>(const DenseLayer<double>&);
+template void QuantizedNetwork::quantize<float>(const DenseNetwork<float>&);
+template void QuantizedNetwork::quantize<double>(const DenseNetwork<double>&);
+template QuantizationReport QuantizedNetwork::evaluate<float>(const DenseNetwork<float>&, const vector<vector<float>>&) const;
+template QuantizationReport QuantizedNetwork::evaluate<double>(const DenseNetwork<double>&, const vector<vector<double>>&) const;
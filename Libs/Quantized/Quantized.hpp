@@ -0,0 +1,211 @@
+// ****************************************************
+// * Code by Kidsadakorn Nuallaoong
+// * Neural Network - Quantized Layer
+// * Int8 post-training quantization for MLP inference
+// ****************************************************
+
+#if !defined(QUANTIZED_H)
+#define QUANTIZED_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "../Activation/Activation.hpp"
+#include "../Dense/Dense.hpp"
+
+using namespace std;
+
+/**
+ * @brief Accuracy of a quantized network against its floating point reference.
+ */
+struct QuantizationReport
+{
+    size_t samples = 0;
+    double maxAbsError = 0;     // * largest |quantized - reference| over every output
+    double meanAbsError = 0;    // * mean |quantized - reference| over every output
+    double top1Agreement = 0;   // * fraction of samples with the same largest output
+};
+
+/**
+ * @brief Float buffers shared by the reduced precision engines (int8, fp16, bf16).
+ *
+ * a and b hold the hidden activations, ping-ponged between layers; the converted copies
+ * let the engines, which only run in float, serve the double overload of predict.
+ */
+struct EngineScratch
+{
+    vector<float> a = vector<float>();
+    vector<float> b = vector<float>();
+
+    // * float copies for the double overload of predict
+    vector<float> convertedInputs = vector<float>();
+    vector<float> convertedOutputs = vector<float>();
+
+    void reserve(size_t widest, int inputSize, int outputSize);
+};
+
+/**
+ * @brief A DenseLayer with int8 weights, one scale per neuron.
+ *
+ * Each weight row is quantized symmetrically: q = round(w / scale) with
+ * scale = max|w| / 127, so every neuron keeps its own dynamic range. Inputs are
+ * quantized per call with a scale and zero point spanning their [min, max] widened to
+ * include 0, so one-signed inputs (raw sensor values, sigmoid outputs) use all 255
+ * levels and the zero point always fits in int8. The dot
+ * products are accumulated in int32, the zero point is removed with the precomputed
+ * row sums, and the result is rescaled to float for the bias and the activation.
+ */
+class QuantizedLayer
+{
+    public:
+        int inputSize = 0;
+        int outputSize = 0;
+
+        vector<int8_t> weights = vector<int8_t>(); // * row-major [outputSize x inputSize]
+        vector<float> scales = vector<float>();    // * per neuron weight scale
+        vector<int32_t> rowSums = vector<int32_t>(); // * per neuron sum of the int8 weights
+        vector<float> bias = vector<float>();
+
+        ActivationType activationKind = LINEAR;
+        ActivationPrecision activationPrecision = PRECISION_EXACT;
+
+    public:
+        QuantizedLayer();
+
+        template <typename T>
+        void quantize(const DenseLayer<T>& layer);
+
+        void forward(const float* inputs, int8_t* quantizedInputs, float* outputs) const;
+};
+
+/**
+ * @brief Int8 inference engine built from a loaded DenseNetwork.
+ *
+ * quantize() converts the weights once (post-training, no calibration needed for
+ * the weights); predict() then runs on KernelsInt8 with int32 accumulation. The
+ * weights take a quarter of the float size and an eighth of double. evaluate()
+ * measures the accuracy delta against the reference network on a calibration set.
+ *
+ * Like DenseNetwork, the const predict overloads take a caller-owned Scratch and can
+ * run concurrently on one network; the overloads without one must not.
+ */
+class QuantizedNetwork
+{
+    public:
+        vector<QuantizedLayer> layers = vector<QuantizedLayer>();
+
+        /**
+         * @brief Per-caller buffers of predict, grown on first use then reused.
+         */
+        struct Scratch : EngineScratch
+        {
+            vector<int8_t> quantizedInputs = vector<int8_t>();
+        };
+
+    public:
+        QuantizedNetwork();
+
+        template <typename T>
+        void quantize(const DenseNetwork<T>& reference);
+
+        template <typename T>
+        QuantizationReport evaluate(const DenseNetwork<T>& reference, const vector<vector<T>>& calibration) const;
+
+        int inputSize() const;
+        int outputSize() const;
+        size_t weightBytes() const;
+
+        void predict(const float* inputs, float* outputs);
+        void predict(const double* inputs, double* outputs);
+        void predict(const float* inputs, float* outputs, Scratch& scratch) const;
+        void predict(const double* inputs, double* outputs, Scratch& scratch) const;
+
+        void clearModel();
+
+    private:
+        // * buffers of the overloads without a Scratch, sized on quantize
+        Scratch scratch = Scratch();
+
+        // * widest layer output and input, the sizes of the scratch buffers
+        size_t widest = 0;
+        size_t widestInput = 0;
+
+        void reserve(Scratch& scratch) const;
+};
+
+/**
+ * @brief Predicts one double precision sample with a float engine.
+ *
+ * @param scratch Holds the converted copies, grown if needed.
+ * @param predict Called as predict(const float* inputs, float* outputs).
+ */
+template <typename Predict>
+void predictConverted(EngineScratch& scratch, const double* inputs, double* outputs, int inputSize, int outputSize, Predict predict)
+{
+    if (scratch.convertedInputs.size() < (size_t)inputSize || scratch.convertedOutputs.size() < (size_t)outputSize) {
+        scratch.reserve(0, inputSize, outputSize);
+    }
+    std::copy(inputs, inputs + inputSize, scratch.convertedInputs.begin());
+    predict(scratch.convertedInputs.data(), scratch.convertedOutputs.data());
+    std::copy(scratch.convertedOutputs.begin(), scratch.convertedOutputs.begin() + outputSize, outputs);
+}
+
+/**
+ * @brief Compares a reduced precision engine with its floating point reference.
+ *
+ * Shared by QuantizedNetwork::evaluate and HalfNetwork::evaluate.
+ *
+ * @param engine Name used in the error messages.
+ * @param reference The network the engine was built from.
+ * @param calibration Representative inputs, one vector of inputSize values per sample.
+ * @param predict The engine, called as predict(const float* inputs, float* outputs).
+ * @return The error statistics over every output of every sample.
+ */
+template <typename T, typename Predict>
+QuantizationReport compareWithReference(const string& engine, const DenseNetwork<T>& reference, const vector<vector<T>>& calibration,
+                                        int inputSize, int outputSize, Predict predict)
+{
+    if (reference.inputSize() != inputSize || reference.outputSize() != outputSize) {
+        std::cerr << "\033[1;31m" << engine << " network does not match the reference\033[0m" << std::endl;
+        throw std::invalid_argument(engine + " network does not match the reference");
+    }
+
+    QuantizationReport report;
+    typename DenseNetwork<T>::Scratch referenceScratch;
+    vector<T> expected(outputSize);
+    vector<float> actual(outputSize);
+    vector<float> input(inputSize);
+    double errorSum = 0;
+    size_t agree = 0;
+    for (const vector<T>& sample : calibration) {
+        if ((int)sample.size() != inputSize) {
+            std::cerr << "\033[1;31mCalibration sample size mismatch\033[0m" << std::endl;
+            throw std::invalid_argument("Calibration sample size mismatch");
+        }
+        reference.predict(sample.data(), expected.data(), referenceScratch);
+        std::copy(sample.begin(), sample.end(), input.begin());
+        predict(input.data(), actual.data());
+
+        for (int o = 0; o < outputSize; ++o) {
+            double error = std::fabs((double)actual[o] - (double)expected[o]);
+            report.maxAbsError = std::max(report.maxAbsError, error);
+            errorSum += error;
+        }
+        if (std::max_element(actual.begin(), actual.end()) - actual.begin() ==
+            std::max_element(expected.begin(), expected.end()) - expected.begin()) {
+            ++agree;
+        }
+        ++report.samples;
+    }
+    if (report.samples > 0) {
+        report.meanAbsError = errorSum / ((double)report.samples * outputSize);
+        report.top1Agreement = (double)agree / report.samples;
+    }
+    return report;
+}
+
+#endif // QUANTIZED_H
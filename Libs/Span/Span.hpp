@@ -0,0 +1,55 @@
+// ****************************************************
+// * Code by Kidsadakorn Nuallaoong
+// * Neural Network - Span
+// * Non-owning view over contiguous values (std::span subset for C++17)
+// ****************************************************
+
+#if !defined(SPAN_H)
+#define SPAN_H
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+using namespace std;
+
+/**
+ * @brief Pointer and length over memory owned by someone else.
+ *
+ * Same meaning as C++20 std::span<T>: copying a Span never copies the values and
+ * never allocates. Span<const T> is built implicitly from a vector or a Span<T>, so
+ * functions taking Span<const T> accept either. The view is invalidated by anything
+ * that reallocates the underlying storage.
+ */
+template <typename T>
+class Span
+{
+    public:
+        typedef typename std::remove_const<T>::type value_type;
+
+        Span() : pointer(nullptr), count(0) {}
+        Span(T* data, size_t size) : pointer(data), count(size) {}
+
+        template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value || std::is_same<U, T>::value>::type>
+        Span(const Span<U>& other) : pointer(other.data()), count(other.size()) {}
+
+        Span(vector<value_type>& values) : pointer(values.data()), count(values.size()) {}
+
+        template <typename U = T, typename = typename std::enable_if<std::is_const<U>::value>::type>
+        Span(const vector<value_type>& values) : pointer(values.data()), count(values.size()) {}
+
+        T* data() const { return pointer; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        T* begin() const { return pointer; }
+        T* end() const { return pointer + count; }
+
+        T& operator[](size_t index) const { return pointer[index]; }
+
+    private:
+        T* pointer;
+        size_t count;
+};
+
+#endif // SPAN_H
@@ -3,30 +3,98 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <future>
+#include <functional>
+#include <set>
+#include <chrono>
 #include <curl/curl.h>
+#include "metrics.hpp"
 
+/**
+ * @brief Request metrics shared by HTTP and AsyncHTTP.
+ */
+struct HTTPMetrics {
+    MetricCounter& requests = Metrics::getInstance().counter("edge_http_requests_total", "HTTP requests completed");
+    MetricCounter& failures = Metrics::getInstance().counter("edge_http_failures_total", "HTTP requests that failed or got a non-2xx status");
+    MetricHistogram& duration = Metrics::getInstance().histogram("edge_http_request_duration_seconds", "HTTP request time from submission to completion");
+    MetricGauge& in_flight = Metrics::getInstance().gauge("edge_http_in_flight", "HTTP requests submitted and not completed yet");
+
+    static HTTPMetrics& get() {
+        static HTTPMetrics instance;
+        return instance;
+    }
+
+    void started() {
+        in_flight.add(1);
+    }
+
+    void finished(std::chrono::steady_clock::time_point start, bool ok) {
+        duration.record(std::chrono::steady_clock::now() - start);
+        requests.inc();
+        if (!ok) {
+            failures.inc();
+        }
+        in_flight.add(-1);
+    }
+};
+
+/**
+ * @brief Small blocking HTTP client on top of libcurl.
+ *
+ * Easy handles are pooled and reused, so repeated requests to the same server keep
+ * their TCP (and TLS) connection alive instead of reconnecting every time. DNS results
+ * and TLS sessions are shared between the pooled handles, and the JSON header list is
+ * built once. Safe to call from several threads; each request takes its own handle.
+ */
 class HTTP {
 public:
     HTTP() {
         curl_global_init(CURL_GLOBAL_DEFAULT);
+
+        share = curl_share_init();
+        if (share) {
+            curl_share_setopt(share, CURLSHOPT_LOCKFUNC, ShareLock);
+            curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, ShareUnlock);
+            curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+
+        json_headers = curl_slist_append(nullptr, "Content-Type: application/json");
     }
 
     ~HTTP() {
+        for (CURL* curl : pool) {
+            curl_easy_cleanup(curl);
+        }
+        pool.clear();
+        curl_slist_free_all(json_headers);
+        if (share) {
+            curl_share_cleanup(share);
+        }
         curl_global_cleanup();
     }
 
+    HTTP(const HTTP&) = delete;
+    HTTP& operator=(const HTTP&) = delete;
+
     std::string get(const std::string& url) {
-        CURL* curl = curl_easy_init();
+        CURL* curl = acquire();
         if (!curl) {
             return "";
         }
 
         std::string response;
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        CURLcode res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
+        CURLcode res = perform(curl);
+        release(curl);
 
         if (res != CURLE_OK) {
             return "";
@@ -36,7 +104,7 @@ public:
     }
 
     std::string post(const std::string& url, const std::string& data) {
-        CURL* curl = curl_easy_init();
+        CURL* curl = acquire();
         if (!curl) {
             return "";
         }
@@ -45,10 +113,10 @@ public:
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
         curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)data.size());
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        CURLcode res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
+        CURLcode res = perform(curl);
+        release(curl);
 
         if (res != CURLE_OK) {
             return "";
@@ -58,25 +126,21 @@ public:
     }
 
     std::string post_json(const std::string& url, const std::string& json_data){
-        CURL* curl = curl_easy_init();
+        CURL* curl = acquire();
         if (!curl) {
             return "";
         }
 
         std::string response;
-        struct curl_slist* headers = nullptr;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
         curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)json_data.size());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, json_headers);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
 
-        CURLcode res = curl_easy_perform(curl);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+        CURLcode res = perform(curl);
+        release(curl);
 
         if (res != CURLE_OK) {
             return "";
@@ -86,10 +150,293 @@ public:
     }
 
 private:
+    // * idle handles, each keeps its open connections between requests
+    std::vector<CURL*> pool;
+    std::mutex pool_mtx;
+
+    // * DNS cache and TLS sessions shared by all handles
+    CURLSH* share = nullptr;
+    std::mutex share_mtx[CURL_LOCK_DATA_LAST];
+
+    // * built once, libcurl only reads it
+    struct curl_slist* json_headers = nullptr;
+
+    // * runs the prepared request and records it in HTTPMetrics
+    CURLcode perform(CURL* curl) {
+        HTTPMetrics& metrics = HTTPMetrics::get();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        metrics.started();
+        CURLcode res = curl_easy_perform(curl);
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        metrics.finished(start, res == CURLE_OK && status >= 200 && status < 300);
+        return res;
+    }
+
+    CURL* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(pool_mtx);
+            if (!pool.empty()) {
+                CURL* curl = pool.back();
+                pool.pop_back();
+                return curl;
+            }
+        }
+
+        CURL* curl = curl_easy_init();
+        if (curl) {
+            setDefaults(curl);
+        }
+        return curl;
+    }
+
+    void release(CURL* curl) {
+        // * reset clears per-request options but keeps the connection and DNS caches
+        curl_easy_reset(curl);
+        setDefaults(curl);
+        std::lock_guard<std::mutex> lock(pool_mtx);
+        pool.push_back(curl);
+    }
+
+    void setDefaults(CURL* curl) {
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 30L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 15L);
+        curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+        curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 300L);
+        if (share) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        }
+    }
+
+    static void ShareLock(CURL*, curl_lock_data data, curl_lock_access, void* userp) {
+        static_cast<HTTP*>(userp)->share_mtx[data].lock();
+    }
+
+    static void ShareUnlock(CURL*, curl_lock_data data, void* userp) {
+        static_cast<HTTP*>(userp)->share_mtx[data].unlock();
+    }
+
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+        ((std::string*)userp)->append((char*)contents, size * nmemb);
+        return size * nmemb;
+    }
+};
+
+/**
+ * @brief Result of an asynchronous request.
+ */
+struct HTTPResponse {
+    CURLcode code = CURLE_OK;   // transport result, CURLE_OPERATION_TIMEDOUT on timeout
+    long status = 0;            // HTTP status code, 0 if no response was received
+    std::string body;
+
+    bool ok() const {
+        return code == CURLE_OK && status >= 200 && status < 300;
+    }
+};
+
+/**
+ * @brief Non-blocking HTTP client, all requests run on one curl_multi event loop thread.
+ *
+ * Requests return immediately, either with a future or by calling a callback when they
+ * finish. Any number can be in flight at once, each with its own timeout, and they share
+ * the multi handle's connection and DNS caches. Callbacks run on the event loop thread,
+ * so they must not block; exceptions thrown by a callback are caught and reported.
+ * Requests still running when the client is destroyed complete with CURLE_ABORTED_BY_CALLBACK.
+ */
+class AsyncHTTP {
+public:
+    typedef std::function<void(const HTTPResponse&)> Callback;
+
+    /**
+     * @param default_timeout_ms Timeout for requests that do not pass their own.
+     */
+    explicit AsyncHTTP(long default_timeout_ms = 5000) : default_timeout(default_timeout_ms) {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        multi = curl_multi_init();
+        json_headers = curl_slist_append(nullptr, "Content-Type: application/json");
+        loop = std::thread(&AsyncHTTP::run, this);
+    }
+
+    ~AsyncHTTP() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        curl_multi_wakeup(multi);
+        if (loop.joinable()) {
+            loop.join();
+        }
+        curl_multi_cleanup(multi);
+        curl_slist_free_all(json_headers);
+        curl_global_cleanup();
+    }
+
+    AsyncHTTP(const AsyncHTTP&) = delete;
+    AsyncHTTP& operator=(const AsyncHTTP&) = delete;
+
+    void get_async(const std::string& url, Callback done, long timeout_ms = 0) {
+        submit(url, nullptr, false, std::move(done), timeout_ms);
+    }
+
+    void post_json_async(const std::string& url, const std::string& json_data, Callback done, long timeout_ms = 0) {
+        submit(url, &json_data, true, std::move(done), timeout_ms);
+    }
+
+    std::future<HTTPResponse> get_async(const std::string& url, long timeout_ms = 0) {
+        std::shared_ptr<std::promise<HTTPResponse>> promise = std::make_shared<std::promise<HTTPResponse>>();
+        std::future<HTTPResponse> result = promise->get_future();
+        get_async(url, [promise](const HTTPResponse& response) { promise->set_value(response); }, timeout_ms);
+        return result;
+    }
+
+    std::future<HTTPResponse> post_json_async(const std::string& url, const std::string& json_data, long timeout_ms = 0) {
+        std::shared_ptr<std::promise<HTTPResponse>> promise = std::make_shared<std::promise<HTTPResponse>>();
+        std::future<HTTPResponse> result = promise->get_future();
+        post_json_async(url, json_data, [promise](const HTTPResponse& response) { promise->set_value(response); }, timeout_ms);
+        return result;
+    }
+
+private:
+    struct Request {
+        CURL* curl = nullptr;
+        std::string url;
+        std::string body;
+        HTTPResponse response;
+        Callback done;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    CURLM* multi = nullptr;
+    struct curl_slist* json_headers = nullptr;
+    long default_timeout;
+
+    // * requests waiting to be added to the multi handle, filled by any thread
+    std::mutex mtx;
+    std::deque<std::unique_ptr<Request>> pending;
+    bool stopping = false;
+    std::thread loop;
+
+    // * transfers added to the multi handle, only touched by the loop thread
+    std::set<CURL*> inflight;
+
+    void submit(const std::string& url, const std::string* json_data, bool json, Callback done, long timeout_ms) {
+        std::unique_ptr<Request> request(new Request());
+        request->url = url;
+        request->done = std::move(done);
+        request->submitted = std::chrono::steady_clock::now();
+        HTTPMetrics::get().started();
+
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            request->response.code = CURLE_FAILED_INIT;
+            complete(*request);
+            return;
+        }
+        request->curl = curl;
+
+        long timeout = (timeout_ms > 0) ? timeout_ms : default_timeout;
+        curl_easy_setopt(curl, CURLOPT_URL, request->url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &request->response.body);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, request.get());
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+        if (json_data != nullptr) {
+            request->body = *json_data;
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->body.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)request->body.size());
+        }
+        if (json) {
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, json_headers);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!stopping) {
+                pending.push_back(std::move(request));
+            }
+        }
+        if (request) {
+            // * client is shutting down
+            request->response.code = CURLE_ABORTED_BY_CALLBACK;
+            curl_easy_cleanup(request->curl);
+            complete(*request);
+            return;
+        }
+        curl_multi_wakeup(multi);
+    }
+
+    void run() {
+        int running = 0;
+        for (;;) {
+            bool stop;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                stop = stopping;
+                while (!pending.empty()) {
+                    curl_multi_add_handle(multi, pending.front()->curl);
+                    inflight.insert(pending.front()->curl);
+                    pending.front().release(); // * owned through CURLOPT_PRIVATE until it completes
+                    pending.pop_front();
+                }
+            }
+            if (stop) {
+                break;
+            }
+
+            curl_multi_perform(multi, &running);
+            finish(false);
+            curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+        }
+        finish(true);
+    }
+
+    // * completes finished transfers, or every transfer when abort is true
+    void finish(bool abort) {
+        CURLMsg* msg;
+        int left;
+        while ((msg = curl_multi_info_read(multi, &left)) != nullptr) {
+            if (msg->msg == CURLMSG_DONE) {
+                done(msg->easy_handle, msg->data.result);
+            }
+        }
+        while (abort && !inflight.empty()) {
+            done(*inflight.begin(), CURLE_ABORTED_BY_CALLBACK);
+        }
+    }
+
+    void done(CURL* curl, CURLcode result) {
+        Request* raw = nullptr;
+        curl_easy_getinfo(curl, CURLINFO_PRIVATE, &raw);
+        std::unique_ptr<Request> request(raw);
+        request->response.code = result;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &request->response.status);
+        curl_multi_remove_handle(multi, curl);
+        inflight.erase(curl);
+        curl_easy_cleanup(curl);
+        complete(*request);
+    }
+
+    static void complete(Request& request) {
+        HTTPMetrics::get().finished(request.submitted, request.response.ok());
+        try {
+            request.done(request.response);
+        } catch (const std::exception& e) {
+            std::cerr << "\033[1;31mHTTP callback error: " << e.what() << "\033[0m" << std::endl;
+        }
+    }
+
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
         ((std::string*)userp)->append((char*)contents, size * nmemb);
         return size * nmemb;
     }
 };
 
-#endif // HTTP_HELPER_HPP)
\ No newline at end of file
+#endif // HTTP_HELPER_HPP
\ No newline at end of file
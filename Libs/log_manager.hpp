@@ -6,72 +6,256 @@
 #include <string>
 #include <ctime>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <unordered_map>
+#include <deque>
+#include <vector>
+#include <filesystem>
+#include <zlib.h>
 
+// Binary log file (LogManager::BINARY), decoded offline by Tools/log_decode.
+// All integers are stored in host byte order (little-endian on every supported target).
+#define LOG_FILE_MAGIC "EFLOG"
+#define LOG_FILE_VERSION 1
+
+struct LogFileHeader {
+    char magic[8];      // "EFLOG"
+    uint32_t version;   // LOG_FILE_VERSION
+    uint32_t reserved;
+};
+
+// Every record starts with a one byte type
+enum LogRecordType {
+    LOG_RECORD_SESSION = 1, // int64 wall clock ns, uint64 monotonic ns: clock origin of the following events
+    LOG_RECORD_STRING = 2,  // uint32 id, uint32 length, text: interns a message literal
+    LOG_RECORD_EVENT = 3    // uint8 level, uint32 thread, uint32 string id (0 = none), uint64 monotonic ns, uint32 length, text
+};
+
+/**
+ * @brief A message that is a string literal: static storage, one text per address.
+ *
+ * Only build it with LOG_LITERAL, which does not compile for anything but a literal.
+ * The logger keeps the pointer and reads it later on its writer thread, and the
+ * binary sink interns it by address, so a buffer that goes out of scope or is reused
+ * would be read after its lifetime or logged with the wrong text.
+ */
+struct LogLiteral {
+    const char* text;
+};
+
+// * "" text "" only compiles when text is a string literal
+#define LOG_LITERAL(text) LogLiteral{"" text ""}
+
+/**
+ * @brief Process-wide asynchronous logger.
+ *
+ * log() only moves the message into a slot of a bounded lock-free MPSC ring buffer,
+ * together with the level and a clock reading; it never formats, locks or touches a
+ * file. A background thread drains the ring, formats the timestamp, writes the file in
+ * batches and flushes it periodically (immediately after errors), then echoes to the
+ * console. When the ring is full the message is dropped (counted and reported) or the
+ * caller waits for a free slot, see setOverflowPolicy().
+ *
+ * Messages below the threshold set with setLogLevel() are skipped; use LOG_MSG so the
+ * message expression is not even evaluated in that case.
+ *
+ * The file is written as text or, to save flash bandwidth, in a compact binary form
+ * (see setLogFile and Tools/log_decode). Messages given with LOG_STATIC / LOG_LITERAL are
+ * passed by pointer and interned in the binary file, so they cost no copy and are stored
+ * once; every other message, char arrays included, is copied into the slot.
+ *
+ * With setRotation() the file is rotated by size and/or age. Rotated files can be gzipped
+ * and the oldest are deleted to keep the total under a cap; compression and cleanup run
+ * on a separate housekeeping thread so neither callers nor the writer wait on them.
+ */
 class LogManager {
 public:
+    // Ordered by severity, a threshold lets through its own level and everything above
     enum LogLevel {
+        DEBUG,
         INFO,
         WARNING,
-        ERR,
-        DEBUG
+        ERR
+    };
+
+    // What log() does when the ring buffer is full
+    enum OverflowPolicy {
+        DROP,   // discard the message, never blocks the caller
+        BLOCK   // wait until the writer thread frees a slot
     };
 
+    // Encoding of the log file, the console always gets text
+    enum LogFormat {
+        TEXT,   // one formatted line per message
+        BINARY  // LOG_RECORD_* records, render with Tools/log_decode
+    };
+
+    // Log file rotation, 0 disables a limit
+    struct RotationPolicy {
+        uint64_t maxFileBytes = 0;                  // rotate once the file reaches this size
+        std::chrono::seconds maxFileAge{0};         // rotate once the file has been open this long
+        bool compress = false;                      // gzip rotated files in the background
+        uint64_t maxTotalBytes = 0;                 // delete the oldest rotated files above this total
+    };
+
+    // Slots in the ring buffer, must be a power of two
+    static const size_t QUEUE_CAPACITY = 4096;
+
     // Singleton pattern
     static LogManager& getInstance() {
         static LogManager instance;
         return instance;
     }
 
-    void setLogFile(const std::string& filename) {
-        std::lock_guard<std::mutex> lock(mutex_);
-
+    void setLogFile(const std::string& filename, LogFormat format = TEXT) {
         if (filename.find(".log") == std::string::npos) {
             std::cerr << "Invalid log file extension: " << filename << std::endl;
             return;
         }
 
+        // * the writer thread owns the file, hold its lock while swapping
+        std::lock_guard<std::mutex> lock(fileMutex_);
         if (logFile_.is_open()) {
             logFile_.close();
         }
-        logFile_.open(filename, std::ios::app);
-        if (!logFile_) {
-            std::cerr << "Failed to open log file: " << filename << std::endl;
+        filename_ = filename;
+        format_ = format;
+        rotationRetryAt_ = std::chrono::steady_clock::time_point();
+        rotationFailing_ = false;
+        openLocked();
+    }
+
+    /**
+     * @brief Enables rotation of the log file, see RotationPolicy.
+     *
+     * Rotated files are renamed to <file>.<YYYYmmdd-HHMMSS> (plus .gz when compressed).
+     */
+    void setRotation(const RotationPolicy& policy) {
+        {
+            std::lock_guard<std::mutex> lock(fileMutex_);
+            rotation_ = policy;
         }
+        std::lock_guard<std::mutex> lock(housekeepingMutex_);
+        if (!housekeeper_.joinable()) {
+            housekeeper_ = std::thread(&LogManager::housekeepingLoop, this);
+        }
+        // * apply the cap to files left by earlier runs
+        housekeepingQueue_.push_back(std::string());
+        housekeepingWake_.notify_one();
     }
 
+    // Sets the threshold for all threads, messages below it are skipped (default INFO)
     void setLogLevel(LogLevel level) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        logLevel_ = level;
+        logLevel_.store(level, std::memory_order_relaxed);
     }
 
-    void log(LogLevel level, const std::string& message) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (level < logLevel_) return; // Skip logs below the current log level
+    bool isEnabled(LogLevel level) const {
+        return level >= logLevel_.load(std::memory_order_relaxed);
+    }
 
-        std::string levelStr = getLogLevelString(level);
-        std::string timestamp = getCurrentTime();
+    // Parses DEBUG, INFO, WARNING or ERROR (any case), returns false if unknown
+    static bool parseLogLevel(std::string name, LogLevel& level) {
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+        if (name == "DEBUG") level = DEBUG;
+        else if (name == "INFO") level = INFO;
+        else if (name == "WARNING") level = WARNING;
+        else if (name == "ERROR" || name == "ERR") level = ERR;
+        else return false;
+        return true;
+    }
 
-        std::string logMessage = "[" + timestamp + "] [" + levelStr + "] " + message;
+    void setOverflowPolicy(OverflowPolicy policy) {
+        overflowPolicy_.store(policy, std::memory_order_relaxed);
+    }
 
-        // Log to file if available
-        if (logFile_) {
-            logFile_ << logMessage << std::endl;
-        }
+    void log(LogLevel level, std::string message) {
+        if (!isEnabled(level)) return; // Skip logs below the current log level
+        enqueue(level, nullptr, std::move(message));
+    }
 
-        // Always log with color level to console
+    // String literals (LOG_LITERAL) are kept by pointer, nothing is copied
+    void log(LogLevel level, LogLiteral literal) {
+        if (!isEnabled(level)) return; // Skip logs below the current log level
+        enqueue(level, literal.text, std::string());
+    }
+
+    static const char* getLogLevelString(LogLevel level) {
         switch (level) {
-            // * timestamp one color , color by log level, message is white
-            case INFO:    std::cout << "\033[0m[\033[90m" << timestamp << "\033[0m] \033[1;32m[INFO] \033[0m" << message << std::endl; break;
-            case WARNING: std::cout << "\033[0m[\033[90m" << timestamp << "\033[0m] \033[1;33m[WARNING] \033[0m" << message << std::endl; break;
-            case ERR:     std::cerr << "\033[0m[\033[90m" << timestamp << "\033[0m] \033[1;31m[ERROR] \033[0m" << message << std::endl; break;
-            case DEBUG:   std::cout << "\033[0m[\033[90m" << timestamp << "\033[0m] \033[1;34m[DEBUG] \033[0m" << message << std::endl; break;
-            default:      std::cerr << "Unknown log level: " << level << std::endl; break;
+            case INFO:    return "INFO";
+            case WARNING: return "WARNING";
+            case ERR:     return "ERROR";
+            case DEBUG:   return "DEBUG";
+            default:      return "UNKNOWN";
         }
     }
 
+    // Messages waiting for the writer thread, approximate (for monitoring)
+    uint64_t queueDepth() const {
+        uint64_t enqueued = enqueuePos_.load(std::memory_order_relaxed);
+        uint64_t drained = drainedPos_.load(std::memory_order_relaxed);
+        return enqueued > drained ? enqueued - drained : 0;
+    }
+
+    // Messages dropped because the ring buffer was full, since start
+    uint64_t droppedTotal() const {
+        return droppedTotal_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Blocks until everything logged before the call is written and flushed.
+     */
+    void flush() {
+        uint64_t target = enqueuePos_.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(flushMutex_);
+        flushRequested_ = true;
+        wake_.notify_one();
+        flushed_.wait(lock, [&] { return flushedTo_ >= target || !running_; });
+    }
+
 private:
-    LogManager() : logLevel_(INFO) {}
+    struct Slot {
+        std::atomic<uint64_t> sequence; // == position: free, == position + 1: filled
+        LogLevel level;
+        uint32_t thread;
+        uint64_t time;          // monotonic ns
+        const char* literal;    // static message text, or nullptr to use message
+        std::string message;
+    };
+
+    LogManager() : logLevel_(INFO), overflowPolicy_(DROP), slots_(new Slot[QUEUE_CAPACITY]) {
+        wallOrigin_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        monoOrigin_ = monotonicNs();
+        for (size_t i = 0; i < QUEUE_CAPACITY; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        writer_ = std::thread(&LogManager::writerLoop, this);
+    }
+
     ~LogManager() {
+        {
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            running_ = false;
+        }
+        wake_.notify_one();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+        {
+            std::lock_guard<std::mutex> lock(housekeepingMutex_);
+            housekeepingStop_ = true;
+        }
+        housekeepingWake_.notify_one();
+        if (housekeeper_.joinable()) {
+            housekeeper_.join();
+        }
         if (logFile_) {
             logFile_.close();
         }
@@ -80,28 +264,526 @@ private:
     LogManager(const LogManager&) = delete;            // Disable copy constructor
     LogManager& operator=(const LogManager&) = delete; // Disable assignment operator
 
-    std::string getLogLevelString(LogLevel level) {
-        switch (level) {
-            case INFO:    return "INFO";
-            case WARNING: return "WARNING";
-            case ERR:     return "ERROR";
-            case DEBUG:   return "DEBUG";
-            default:      return "UNKNOWN";
+    static uint64_t monotonicNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // * small per-thread number, cheaper to store than std::thread::id
+    static uint32_t threadId() {
+        static std::atomic<uint32_t> next(1);
+        thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    template <typename V>
+    static void put(std::string& out, V value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void enqueue(LogLevel level, const char* literal, std::string&& message) {
+        uint64_t pos;
+        Slot* slot = claim(pos);
+        if (slot == nullptr) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            droppedTotal_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        slot->level = level;
+        slot->thread = threadId();
+        slot->time = monotonicNs();
+        slot->literal = literal;
+        slot->message = std::move(message);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    // * reserves the next slot for a producer, nullptr if the ring is full under DROP
+    Slot* claim(uint64_t& pos) {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot* slot = &slots_[pos & (QUEUE_CAPACITY - 1)];
+            uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return slot;
+                }
+            } else if (seq < pos) {
+                // * full: the slot still holds a message from the previous lap
+                if (overflowPolicy_.load(std::memory_order_relaxed) == DROP) {
+                    return nullptr;
+                }
+                wake_.notify_one();
+                std::this_thread::yield();
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
         }
     }
 
-    std::string getCurrentTime() {
+    void writerLoop() {
+        using namespace std::chrono;
+        steady_clock::time_point lastFlush = steady_clock::now();
+        bool dirty = false;
+        for (;;) {
+            bool urgent = false;
+            size_t count = drain(urgent);
+            uint64_t drainedTo = dequeuePos_;
+            drainedPos_.store(drainedTo, std::memory_order_relaxed);
+            if (count > 0) {
+                dirty = true;
+            }
+
+            uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) {
+                std::lock_guard<std::mutex> lock(fileMutex_);
+                writeLocked(WARNING, monotonicNs(), 0, nullptr, std::to_string(dropped) + " log messages dropped, log buffer full");
+                dirty = true;
+            }
+
+            bool flushNow;
+            bool stop;
+            {
+                std::lock_guard<std::mutex> lock(flushMutex_);
+                flushNow = flushRequested_;
+                flushRequested_ = false;
+                stop = !running_;
+            }
+            if (dirty && (urgent || flushNow || stop || steady_clock::now() - lastFlush >= milliseconds(500))) {
+                std::lock_guard<std::mutex> lock(fileMutex_);
+                if (logFile_) {
+                    logFile_.flush();
+                }
+                std::cout.flush();
+                dirty = false;
+                lastFlush = steady_clock::now();
+            }
+            if (!dirty) {
+                // * everything drained so far has reached the file
+                {
+                    std::lock_guard<std::mutex> lock(flushMutex_);
+                    flushedTo_ = drainedTo;
+                }
+                flushed_.notify_all();
+            }
+
+            if (stop && dequeuePos_ == enqueuePos_.load(std::memory_order_acquire)) {
+                return;
+            }
+            if (count == 0) {
+                // * producers never signal, an idle writer just naps
+                std::unique_lock<std::mutex> lock(flushMutex_);
+                wake_.wait_for(lock, milliseconds(20), [&] { return flushRequested_ || !running_; });
+            }
+        }
+    }
+
+    // * writes every filled slot in order, urgent is set when an error went by
+    size_t drain(bool& urgent) {
+        size_t count = 0;
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        for (;;) {
+            Slot& slot = slots_[dequeuePos_ & (QUEUE_CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1) {
+                break;
+            }
+            writeLocked(slot.level, slot.time, slot.thread, slot.literal, slot.message);
+            urgent = urgent || slot.level == ERR;
+            slot.message.clear();
+            slot.sequence.store(dequeuePos_ + QUEUE_CAPACITY, std::memory_order_release);
+            ++dequeuePos_;
+            ++count;
+        }
+        if (rotationDue()) {
+            rotateLocked();
+        }
+        return count;
+    }
+
+    // * opens filename_ for appending, writes the binary header/session when needed
+    void openLocked() {
+        std::error_code ec;
+        uint64_t existing = std::filesystem::file_size(filename_, ec);
+        if (ec) {
+            existing = 0;
+        }
+        logFile_.clear();
+        logFile_.open(filename_, std::ios::app | std::ios::binary);
+        if (!logFile_) {
+            std::cerr << "Failed to open log file: " << filename_ << std::endl;
+            return;
+        }
+        fileBytes_ = existing;
+        eventsSinceOpen_ = 0;
+        openedAt_ = std::chrono::steady_clock::now();
+        if (format_ == BINARY) {
+            // * string ids are only valid within a session, the decoder resets on each one
+            interned_.clear();
+            record_.clear();
+            if (existing == 0) {
+                LogFileHeader file = {};
+                std::memcpy(file.magic, LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC));
+                file.version = LOG_FILE_VERSION;
+                record_.append(reinterpret_cast<const char*>(&file), sizeof(file));
+            }
+            put<uint8_t>(record_, LOG_RECORD_SESSION);
+            put<int64_t>(record_, wallOrigin_);
+            put<uint64_t>(record_, monoOrigin_);
+            writeFile(record_);
+        }
+    }
+
+    bool rotationDue() const {
+        if (!logFile_.is_open() || std::chrono::steady_clock::now() < rotationRetryAt_) {
+            return false;
+        }
+        if (rotation_.maxFileBytes > 0 && fileBytes_ >= rotation_.maxFileBytes) {
+            return true;
+        }
+        // * an idle file is not rotated by age, that would only produce empty files
+        return rotation_.maxFileAge.count() > 0 && eventsSinceOpen_ > 0 && std::chrono::steady_clock::now() - openedAt_ >= rotation_.maxFileAge;
+    }
+
+    // * renames the current file and starts a new one, compression and cleanup are queued
+    void rotateLocked() {
+        logFile_.close();
+
+        char stamp[32];
         std::time_t now = std::time(nullptr);
-        char buf[80];
-        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
-        return std::string(buf);
+        std::tm tm;
+#if defined(_WIN32)
+        localtime_s(&tm, &now);
+#else
+        localtime_r(&now, &tm);
+#endif
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+        std::string rotated = filename_ + "." + stamp;
+        std::error_code ec;
+        for (int n = 1; std::filesystem::exists(rotated, ec) || std::filesystem::exists(rotated + ".gz", ec); ++n) {
+            rotated = filename_ + "." + stamp + "-" + std::to_string(n);
+        }
+        std::filesystem::rename(filename_, rotated, ec);
+        if (ec) {
+            // * keep appending to the same file, retry later and report only the first failure
+            if (!rotationFailing_) {
+                std::cerr << "\033[1;31mFailed to rotate log file " << filename_ << ": " << ec.message()
+                          << ", retrying every " << ROTATION_RETRY.count() << " s\033[0m" << std::endl;
+            }
+            rotationFailing_ = true;
+            rotationRetryAt_ = std::chrono::steady_clock::now() + ROTATION_RETRY;
+            openLocked();
+            return;
+        }
+        if (rotationFailing_) {
+            std::cerr << "Log file " << filename_ << " rotated again" << std::endl;
+            rotationFailing_ = false;
+        }
+        openLocked();
+
+        std::lock_guard<std::mutex> lock(housekeepingMutex_);
+        if (!housekeeper_.joinable()) {
+            housekeeper_ = std::thread(&LogManager::housekeepingLoop, this);
+        }
+        housekeepingQueue_.push_back(rotated);
+        housekeepingWake_.notify_one();
+    }
+
+    void writeFile(const std::string& data) {
+        logFile_.write(data.data(), data.size());
+        fileBytes_ += data.size();
+    }
+
+    // * compresses rotated files and enforces the total size cap, off the writer thread
+    void housekeepingLoop() {
+        for (;;) {
+            std::string rotated;
+            {
+                std::unique_lock<std::mutex> lock(housekeepingMutex_);
+                housekeepingWake_.wait(lock, [&] { return housekeepingStop_ || !housekeepingQueue_.empty(); });
+                if (housekeepingQueue_.empty()) {
+                    return;
+                }
+                rotated = housekeepingQueue_.front();
+                housekeepingQueue_.pop_front();
+            }
+
+            std::string active;
+            RotationPolicy policy;
+            {
+                std::lock_guard<std::mutex> lock(fileMutex_);
+                active = filename_;
+                policy = rotation_;
+            }
+            if (!rotated.empty() && policy.compress) {
+                gzipFile(rotated);
+            }
+            if (policy.maxTotalBytes > 0 && !active.empty()) {
+                enforceCap(active, policy.maxTotalBytes);
+            }
+        }
+    }
+
+    static bool gzipFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        std::string target = path + ".gz";
+        std::string temp = target + ".tmp";
+        gzFile out = gzopen(temp.c_str(), "wb6");
+        if (out == nullptr) {
+            return false;
+        }
+        std::vector<char> buffer(1 << 16);
+        bool ok = true;
+        while (ok && (in.read(buffer.data(), buffer.size()) || in.gcount() > 0)) {
+            ok = gzwrite(out, buffer.data(), static_cast<unsigned>(in.gcount())) > 0;
+        }
+        ok = (gzclose(out) == Z_OK) && ok;
+        in.close();
+
+        std::error_code ec;
+        if (!ok) {
+            std::cerr << "\033[1;31mFailed to compress log file " << path << "\033[0m" << std::endl;
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        std::filesystem::rename(temp, target, ec);
+        if (!ec) {
+            std::filesystem::remove(path, ec);
+        }
+        return !ec;
+    }
+
+    // * true for the names rotateLocked produces: <active>.<YYYYmmdd-HHMMSS>[-n][.gz]
+    static bool isRotatedName(const std::string& name, const std::string& prefix) {
+        if (name.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+        std::string rest = name.substr(prefix.size());
+        if (rest.size() > 3 && rest.compare(rest.size() - 3, 3, ".gz") == 0) {
+            rest.resize(rest.size() - 3);
+        }
+        auto digits = [&](size_t from, size_t count) {
+            for (size_t i = from; i < from + count; ++i) {
+                if (i >= rest.size() || !std::isdigit(static_cast<unsigned char>(rest[i]))) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (rest.size() < 15 || !digits(0, 8) || rest[8] != '-' || !digits(9, 6)) {
+            return false;
+        }
+        if (rest.size() == 15) {
+            return true;
+        }
+        return rest[15] == '-' && rest.size() > 16 && digits(16, rest.size() - 16);
+    }
+
+    // * deletes the oldest rotated files of active until active + rotated fit in maxTotalBytes;
+    // * other files sharing the prefix (e.g. activity.log.bin next to activity.log) are left alone
+    static void enforceCap(const std::string& active, uint64_t maxTotalBytes) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::path activePath(active);
+        fs::path dir = activePath.has_parent_path() ? activePath.parent_path() : fs::path(".");
+        std::string prefix = activePath.filename().string() + ".";
+
+        uint64_t total = fs::file_size(activePath, ec);
+        if (ec) {
+            total = 0;
+        }
+        struct Rotated {
+            fs::file_time_type time;
+            std::string path;
+            uint64_t size;
+            bool operator<(const Rotated& other) const {
+                return time < other.time || (time == other.time && path < other.path);
+            }
+        };
+        std::vector<Rotated> rotated;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            std::string name = it->path().filename().string();
+            if (!isRotatedName(name, prefix)) {
+                continue;
+            }
+            std::error_code entry_ec;
+            uint64_t size = fs::file_size(it->path(), entry_ec);
+            fs::file_time_type time = fs::last_write_time(it->path(), entry_ec);
+            if (entry_ec) {
+                continue;
+            }
+            rotated.push_back(Rotated{time, it->path().string(), size});
+            total += size;
+        }
+
+        // * oldest first
+        std::sort(rotated.begin(), rotated.end());
+        for (size_t i = 0; i < rotated.size() && total > maxTotalBytes; ++i) {
+            if (fs::remove(rotated[i].path, ec)) {
+                total -= rotated[i].size;
+            }
+        }
+    }
+
+    void writeLocked(LogLevel level, uint64_t time, uint32_t thread, const char* literal, const std::string& text) {
+        const char* message = literal ? literal : text.c_str();
+        int64_t wall = wallOrigin_ + static_cast<int64_t>(time - monoOrigin_);
+        const char* timestamp = formatTime(static_cast<std::time_t>(wall / 1000000000));
+
+        // Log to file if available
+        if (logFile_) {
+            ++eventsSinceOpen_;
+        }
+        if (logFile_ && format_ == BINARY) {
+            writeBinary(level, time, thread, literal, text);
+        } else if (logFile_) {
+            record_.clear();
+            record_ += '[';
+            record_ += timestamp;
+            record_ += "] [";
+            record_ += getLogLevelString(level);
+            record_ += "] ";
+            record_ += message;
+            record_ += '\n';
+            writeFile(record_);
+        }
+
+        // Always log with color level to console
+        switch (level) {
+            // * timestamp one color , color by log level, message is white
+            case INFO:    std::cout << "\033[0m[\033[90m" << timestamp << "\033[0m] \033[1;32m[INFO] \033[0m" << message << '\n'; break;
+            case WARNING: std::cout << "\033[0m[\033[90m" << timestamp << "\033[0m] \033[1;33m[WARNING] \033[0m" << message << '\n'; break;
+            case ERR:     std::cerr << "\033[0m[\033[90m" << timestamp << "\033[0m] \033[1;31m[ERROR] \033[0m" << message << '\n'; break;
+            case DEBUG:   std::cout << "\033[0m[\033[90m" << timestamp << "\033[0m] \033[1;34m[DEBUG] \033[0m" << message << '\n'; break;
+            default:      std::cerr << "Unknown log level: " << level << '\n'; break;
+        }
+    }
+
+    void writeBinary(LogLevel level, uint64_t time, uint32_t thread, const char* literal, const std::string& text) {
+        record_.clear();
+        uint32_t id = 0;
+        if (literal != nullptr) {
+            std::unordered_map<const char*, uint32_t>::iterator it = interned_.find(literal);
+            if (it == interned_.end()) {
+                id = static_cast<uint32_t>(interned_.size() + 1);
+                interned_.emplace(literal, id);
+                uint32_t length = static_cast<uint32_t>(std::strlen(literal));
+                put<uint8_t>(record_, LOG_RECORD_STRING);
+                put<uint32_t>(record_, id);
+                put<uint32_t>(record_, length);
+                record_.append(literal, length);
+            } else {
+                id = it->second;
+            }
+        }
+        put<uint8_t>(record_, LOG_RECORD_EVENT);
+        put<uint8_t>(record_, static_cast<uint8_t>(level));
+        put<uint32_t>(record_, thread);
+        put<uint32_t>(record_, id);
+        put<uint64_t>(record_, time);
+        put<uint32_t>(record_, static_cast<uint32_t>(text.size()));
+        record_.append(text);
+        writeFile(record_);
+    }
+
+    // * only called by the writer thread, the text changes once per second
+    const char* formatTime(std::time_t now) {
+        if (now != cachedTime_) {
+            std::tm tm;
+#if defined(_WIN32)
+            localtime_s(&tm, &now);
+#else
+            localtime_r(&now, &tm);
+#endif
+            std::strftime(cachedStamp_, sizeof(cachedStamp_), "%Y-%m-%d %H:%M:%S", &tm);
+            cachedTime_ = now;
+        }
+        return cachedStamp_;
     }
 
     std::ofstream logFile_;
-    LogLevel logLevel_;
-    std::mutex mutex_;
+    std::mutex fileMutex_;
+    std::string filename_;
+    LogFormat format_ = TEXT;
+
+    // * rotation state, guarded by fileMutex_
+    RotationPolicy rotation_;
+    uint64_t fileBytes_ = 0;
+    uint64_t eventsSinceOpen_ = 0;
+    std::chrono::steady_clock::time_point openedAt_;
+    // * after a failed rename rotation waits until rotationRetryAt_, the failure is reported once
+    static constexpr std::chrono::seconds ROTATION_RETRY{60};
+    std::chrono::steady_clock::time_point rotationRetryAt_;
+    bool rotationFailing_ = false;
+
+    // * rotated files waiting for compression / cleanup (empty name: cleanup only)
+    std::thread housekeeper_;
+    std::mutex housekeepingMutex_;
+    std::condition_variable housekeepingWake_;
+    std::deque<std::string> housekeepingQueue_;
+    bool housekeepingStop_ = false;
+
+    // * binary sink state, guarded by fileMutex_
+    std::unordered_map<const char*, uint32_t> interned_;
+    std::string record_;
+
+    // * clock origin, maps monotonic event times to wall clock
+    int64_t wallOrigin_;
+    uint64_t monoOrigin_;
+    std::atomic<LogLevel> logLevel_;
+    std::atomic<OverflowPolicy> overflowPolicy_;
+
+    // * ring buffer, producers advance enqueuePos_, the writer thread owns dequeuePos_
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> enqueuePos_{0};
+    alignas(64) uint64_t dequeuePos_ = 0;
+    std::atomic<uint64_t> dropped_{0};
+    // * monitoring copies, dequeuePos_ itself is only read by the writer thread
+    std::atomic<uint64_t> drainedPos_{0};
+    std::atomic<uint64_t> droppedTotal_{0};
+
+    // * writer thread wake-up, shutdown and flush() hand-shake
+    std::thread writer_;
+    std::mutex flushMutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    bool running_ = true;
+    bool flushRequested_ = false;
+    uint64_t flushedTo_ = 0;
+
+    std::time_t cachedTime_ = -1;
+    char cachedStamp_[32] = {0};
 };
 
 
 
+/**
+ * @brief Logs a message at the given level (DEBUG, INFO, WARNING or ERR).
+ *
+ * The message expression is only evaluated when the level passes the threshold, so
+ * disabled statements cost one relaxed atomic load.
+ */
+#define LOG_MSG(level, message)                                                     \
+    do {                                                                            \
+        LogManager& log_manager_ = LogManager::getInstance();                       \
+        if (log_manager_.isEnabled(LogManager::level)) {                            \
+            log_manager_.log(LogManager::level, message);                           \
+        }                                                                           \
+    } while (0)
+
+/**
+ * @brief Logs a string literal at the given level without copying it.
+ *
+ * Same as LOG_MSG for messages that are literals, which are then kept by pointer and
+ * interned in the binary log. Fails to compile for anything else, use LOG_MSG there.
+ */
+#define LOG_STATIC(level, literal)                                                  \
+    do {                                                                            \
+        LogManager& log_manager_ = LogManager::getInstance();                       \
+        if (log_manager_.isEnabled(LogManager::level)) {                            \
+            log_manager_.log(LogManager::level, LOG_LITERAL(literal));              \
+        }                                                                           \
+    } while (0)
+
 #endif // LOG_MANAGER_HPP
@@ -0,0 +1,233 @@
+#if !defined(METRICS_HPP)
+#define METRICS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+/**
+ * @brief Monotonic event count, lock-free.
+ */
+class MetricCounter {
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @brief Value that goes up and down (queue depth, state), lock-free.
+ */
+class MetricGauge {
+public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * @brief Lock-free latency histogram with HDR-style log-linear buckets.
+ *
+ * Durations are recorded in nanoseconds. Each power of two is split into 16 linear
+ * sub-buckets, so any quantile is within 1/16 (6.25%) of the true value over the whole
+ * 1 ns .. 2^63 ns range, with a fixed 976 counters and no allocation while recording.
+ */
+class MetricHistogram {
+public:
+    static const int SUB_BITS = 4;
+    static const uint64_t SUB_COUNT = uint64_t(1) << SUB_BITS;
+    static const size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    void record(uint64_t ns) {
+        buckets_[index(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    void record(std::chrono::nanoseconds duration) {
+        record(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Value at quantile q (0..1) in nanoseconds, the upper edge of its bucket.
+     */
+    uint64_t quantile(double q) const {
+        uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+        rank = std::min(std::max<uint64_t>(rank, 1), total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(upper(i), max());
+            }
+        }
+        return max();
+    }
+
+private:
+    static size_t index(uint64_t v) {
+        if (v < SUB_COUNT) {
+            return static_cast<size_t>(v);
+        }
+        int exponent = 63 - __builtin_clzll(v);
+        uint64_t sub = (v >> (exponent - SUB_BITS)) & (SUB_COUNT - 1);
+        return static_cast<size_t>((exponent - SUB_BITS + 1) * SUB_COUNT + sub);
+    }
+
+    static uint64_t upper(size_t i) {
+        if (i < SUB_COUNT) {
+            return i;
+        }
+        int shift = static_cast<int>(i / SUB_COUNT) - 1;
+        uint64_t sub = i % SUB_COUNT;
+        return ((SUB_COUNT + sub + 1) << shift) - 1;
+    }
+
+    std::atomic<uint64_t> buckets_[BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @brief Process-wide registry of named metrics, rendered in the Prometheus text format.
+ *
+ * Registration (counter(), gauge(), histogram(), callback()) takes a lock and returns a
+ * reference that stays valid for the life of the process; asking again for the same name
+ * returns the same metric. Keep the reference and update it directly, the hot path is a
+ * relaxed atomic add. Histograms are exposed as summaries in seconds (p50, p90, p99,
+ * p99.9, plus _sum and _count); callbacks are evaluated at scrape time, for values the
+ * owner already tracks such as queue depths.
+ */
+class Metrics {
+public:
+    enum Type {
+        COUNTER,
+        GAUGE,
+        SUMMARY
+    };
+
+    // Singleton pattern
+    static Metrics& getInstance() {
+        static Metrics instance;
+        return instance;
+    }
+
+    MetricCounter& counter(const std::string& name, const std::string& help) {
+        return *entry(name, help, COUNTER).counter;
+    }
+
+    MetricGauge& gauge(const std::string& name, const std::string& help) {
+        return *entry(name, help, GAUGE).gauge;
+    }
+
+    MetricHistogram& histogram(const std::string& name, const std::string& help) {
+        return *entry(name, help, SUMMARY).histogram;
+    }
+
+    // Value computed on every scrape, type is COUNTER or GAUGE
+    void callback(const std::string& name, const std::string& help, Type type, std::function<double()> read) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Entry& e = metrics_[name];
+        e.help = help;
+        e.type = type;
+        e.read = std::move(read);
+    }
+
+    /**
+     * @brief All metrics in the Prometheus text exposition format (version 0.0.4).
+     */
+    std::string render() const {
+        std::ostringstream out;
+        out << std::setprecision(9);
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (const auto& item : metrics_) {
+            const std::string& name = item.first;
+            const Entry& e = item.second;
+            out << "# HELP " << name << ' ' << e.help << '\n';
+            out << "# TYPE " << name << ' ' << typeName(e.type) << '\n';
+            if (e.read) {
+                out << name << ' ' << e.read() << '\n';
+            } else if (e.counter) {
+                out << name << ' ' << e.counter->value() << '\n';
+            } else if (e.gauge) {
+                out << name << ' ' << e.gauge->value() << '\n';
+            } else if (e.histogram) {
+                const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+                for (double q : quantiles) {
+                    out << name << "{quantile=\"" << q << "\"} " << e.histogram->quantile(q) * 1e-9 << '\n';
+                }
+                out << name << "_sum " << e.histogram->sum() * 1e-9 << '\n';
+                out << name << "_count " << e.histogram->count() << '\n';
+            }
+        }
+        return out.str();
+    }
+
+private:
+    struct Entry {
+        std::string help;
+        Type type = COUNTER;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+        std::function<double()> read;
+    };
+
+    Metrics() = default;
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    Entry& entry(const std::string& name, const std::string& help, Type type) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Entry& e = metrics_[name];
+        if (e.help.empty()) {
+            e.help = help;
+            e.type = type;
+        }
+        if (type == COUNTER && !e.counter) e.counter.reset(new MetricCounter());
+        if (type == GAUGE && !e.gauge) e.gauge.reset(new MetricGauge());
+        if (type == SUMMARY && !e.histogram) e.histogram.reset(new MetricHistogram());
+        return e;
+    }
+
+    static const char* typeName(Type type) {
+        switch (type) {
+            case COUNTER: return "counter";
+            case GAUGE:   return "gauge";
+            case SUMMARY: return "summary";
+            default:      return "untyped";
+        }
+    }
+
+    // * std::map nodes never move, references handed out stay valid
+    std::map<std::string, Entry> metrics_;
+    mutable std::mutex mtx_;
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,239 @@
+#if !defined(PIPELINE_PROBE_HPP)
+#define PIPELINE_PROBE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <ctime>
+    #include <sys/resource.h>
+#endif
+
+/**
+ * @brief CPU time used so far by the calling thread, in seconds.
+ */
+inline double thread_cpu_seconds() {
+#if defined(_WIN32)
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 1e-7;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+/**
+ * @brief CPU time used so far by the whole process (all threads), in seconds.
+ */
+inline double process_cpu_seconds() {
+#if defined(_WIN32)
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 1e-7;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#endif
+}
+
+/**
+ * @brief Measures sample-to-send latency and per-thread CPU of the sensor pipeline.
+ *
+ * The sampling stage calls sampled(sequence) right after it stores a frame, the send
+ * stage calls sent(sequence) once send() returns, i.e. the frame is handed to the socket;
+ * the difference is recorded per frame. Time on the wire and at the peer is not included.
+ * Pipeline threads hold a ThreadScope, which reports the thread's CPU time when it exits.
+ * Everything is a no-op until enable(true), so the hooks can stay in the production paths.
+ */
+class PipelineProbe {
+public:
+    /**
+     * @brief Reports the CPU time of the enclosing thread to the probe on scope exit.
+     */
+    class ThreadScope {
+    public:
+        ThreadScope(PipelineProbe& probe, const char* name) : probe_(probe), name_(name) {}
+        ~ThreadScope() { probe_.thread_exited(name_, thread_cpu_seconds()); }
+        ThreadScope(const ThreadScope&) = delete;
+        ThreadScope& operator=(const ThreadScope&) = delete;
+
+    private:
+        PipelineProbe& probe_;
+        const char* name_;
+    };
+
+    PipelineProbe() = default;
+    PipelineProbe(const PipelineProbe&) = delete;
+    PipelineProbe& operator=(const PipelineProbe&) = delete;
+
+    void enable(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Starts a new measurement window, clearing latencies and thread reports.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        latencies_ns_.clear();
+        threads_.clear();
+        for (Slot& slot : slots_) {
+            slot.sequence.store(0, std::memory_order_relaxed);
+        }
+        started_ = std::chrono::steady_clock::now();
+        started_cpu_ = process_cpu_seconds();
+        stopped_ = false;
+    }
+
+    /**
+     * @brief Ends the measurement window, so shutdown time is not counted in the rates.
+     */
+    void stop() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopped_at_ = std::chrono::steady_clock::now();
+        stopped_cpu_ = process_cpu_seconds();
+        stopped_ = true;
+    }
+
+    void sampled(uint64_t sequence) {
+        if (!enabled()) {
+            return;
+        }
+        Slot& slot = slots_[sequence % SLOTS];
+        slot.time_ns.store(now_ns(), std::memory_order_relaxed);
+        slot.sequence.store(sequence, std::memory_order_release);
+    }
+
+    void sent(uint64_t sequence) {
+        if (!enabled()) {
+            return;
+        }
+        int64_t now = now_ns();
+        Slot& slot = slots_[sequence % SLOTS];
+        if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+            return; // * sampled before the window started, or already overwritten
+        }
+        int64_t latency = now - slot.time_ns.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mtx_);
+        latencies_ns_.push_back(latency);
+    }
+
+    void thread_exited(const char* name, double cpu_seconds) {
+        if (!enabled()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            threads_[name] += cpu_seconds;
+        }
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief Waits until a thread with this name has reported, detached threads included.
+     *
+     * @return false if it did not exit within the timeout.
+     */
+    bool wait_for_thread(const std::string& name, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return cv_.wait_for(lock, timeout, [&] { return threads_.count(name) != 0; });
+    }
+
+    /**
+     * @brief Summary of the window from reset() to stop() (or now).
+     *
+     * Latencies are in microseconds (nearest-rank percentiles), CPU is in milliseconds and
+     * in percent of one core over the window. "process" covers every thread, including
+     * ones without a ThreadScope (HTTP event loop, log writer).
+     */
+    nlohmann::json report() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::chrono::steady_clock::time_point end = stopped_ ? stopped_at_ : std::chrono::steady_clock::now();
+        double end_cpu = stopped_ ? stopped_cpu_ : process_cpu_seconds();
+        double seconds = std::chrono::duration<double>(end - started_).count();
+        std::vector<int64_t> sorted(latencies_ns_);
+        std::sort(sorted.begin(), sorted.end());
+
+        nlohmann::json cpu = nlohmann::json::object();
+        for (const auto& thread : threads_) {
+            cpu[thread.first] = cpu_entry(thread.second, seconds);
+        }
+        cpu["process"] = cpu_entry(end_cpu - started_cpu_, seconds);
+
+        return {
+            {"seconds", seconds},
+            {"messages", sorted.size()},
+            {"messages_per_second", seconds > 0 ? sorted.size() / seconds : 0.0},
+            {"latency_us", {
+                {"p50", percentile_us(sorted, 0.50)},
+                {"p99", percentile_us(sorted, 0.99)},
+                {"p999", percentile_us(sorted, 0.999)},
+                {"max", sorted.empty() ? 0.0 : sorted.back() / 1000.0}
+            }},
+            {"cpu", cpu}
+        };
+    }
+
+private:
+    static const size_t SLOTS = 1024;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<int64_t> time_ns{0};
+    };
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static double percentile_us(const std::vector<int64_t>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        return sorted[rank - 1] / 1000.0;
+    }
+
+    static nlohmann::json cpu_entry(double cpu_seconds, double seconds) {
+        return {
+            {"ms", cpu_seconds * 1000.0},
+            {"percent", seconds > 0 ? cpu_seconds / seconds * 100.0 : 0.0}
+        };
+    }
+
+    std::atomic<bool> enabled_{false};
+    Slot slots_[SLOTS];
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<int64_t> latencies_ns_;
+    std::map<std::string, double> threads_;
+    std::chrono::steady_clock::time_point started_ = std::chrono::steady_clock::now();
+    double started_cpu_ = 0.0;
+    std::chrono::steady_clock::time_point stopped_at_;
+    double stopped_cpu_ = 0.0;
+    bool stopped_ = false;
+};
+
+#endif // PIPELINE_PROBE_HPP
@@ -0,0 +1,325 @@
+#if !defined(SENSOR_FRAME_HPP)
+#define SENSOR_FRAME_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <charconv>
+#include <memory>
+#include <mutex>
+
+// Number of event classes (Cold, Warm, Hot, Dry, Wet, Normal, Unknown)
+#define SENSOR_EVENT_COUNT 7
+
+// Value of SensorFrame::mode in PREDICTION mode (matches PREDICTION_MODE in main.cpp)
+#define SENSOR_MODE_PREDICTION 1
+
+/**
+ * @brief One sensor sample, plain data so it can be published through a SeqLock.
+ */
+struct SensorFrame {
+    uint64_t sequence;      // 1 for the first sample, 0 means no sample yet
+    std::time_t timestamp;  // sampling time (seconds since epoch)
+    int32_t event;          // index into the Event names
+    int32_t mode;           // operating mode when sampled
+    double co2;
+    double voc;
+    double ra;
+    double temp;
+    double humid;
+    double pressure;
+};
+
+/**
+ * @brief Latest model output, published separately by the AI thread.
+ */
+struct PredictionFrame {
+    uint64_t sequence;                  // SensorFrame::sequence the prediction was computed from
+    double values[SENSOR_EVENT_COUNT];  // percent per event, same order as the Event names
+};
+
+/**
+ * @brief A sensor frame with the prediction published for it, one snapshot for the senders.
+ */
+struct PublishedFrame {
+    SensorFrame sensor;
+    PredictionFrame prediction;         // sequence is 0 until a model has run once
+};
+
+/**
+ * @brief Serializes sensor frames straight to the wire JSON, without building a DOM.
+ *
+ * The output has the layout of dump() / dump(4) on the equivalent nlohmann::json
+ * object (sorted keys, same number notation); numbers are the shortest round-trip
+ * digits, so they parse back to exactly the same values. The buffer is reused
+ * between calls, so after the first message no allocation happens. One writer
+ * per thread.
+ */
+class SensorFrameWriter {
+public:
+    SensorFrameWriter(const char* const* event_names, const std::string& hardware_id)
+        : event_names_(event_names), hardware_id_(hardware_id) {
+        buffer_.reserve(512);
+    }
+
+    /**
+     * @brief Writes the message for a frame.
+     *
+     * @param frame The sensor sample.
+     * @param prediction The prediction to include (PREDICTION variant) or nullptr (SAFE variant).
+     * @param pretty true for the dump(4) layout used on the console.
+     * @return The serialized message, valid until the next call.
+     */
+    const std::string& write(const SensorFrame& frame, const PredictionFrame* prediction, bool pretty = false) {
+        static const int data_order[] = {0, 4, 5, 2, 3, 1};  // CO2, HUMID, PRESSURE, RA, TEMP, VOC
+        static const char* const data_keys[] = {"CO2", "VOC", "RA", "TEMP", "HUMID", "PRESSURE"};
+        const double data[] = {frame.co2, frame.voc, frame.ra, frame.temp, frame.humid, frame.pressure};
+
+        pretty_ = pretty;
+        buffer_.clear();
+        buffer_ += '{';
+
+        key("Data", 1);
+        buffer_ += '{';
+        for (int i = 0; i < 6; ++i) {
+            if (i > 0) buffer_ += ',';
+            key(data_keys[data_order[i]], 2);
+            number(data[data_order[i]]);
+        }
+        close('}', 1);
+
+        buffer_ += ',';
+        key("Event", 1);
+        string(event_names_[frame.event]);
+
+        buffer_ += ',';
+        key("HardwareID", 1);
+        string(hardware_id_.c_str());
+
+        buffer_ += ',';
+        key("Mode", 1);
+        string(frame.mode == SENSOR_MODE_PREDICTION ? "PREDICTION" : "SAFE");
+
+        if (prediction != nullptr) {
+            // * Event names sorted: Cold, Dry, Hot, Normal, Unknown, Warm, Wet
+            static const int prediction_order[] = {0, 3, 2, 5, 6, 1, 4};
+            buffer_ += ',';
+            key("Prediction", 1);
+            buffer_ += '{';
+            for (int i = 0; i < SENSOR_EVENT_COUNT; ++i) {
+                if (i > 0) buffer_ += ',';
+                key(event_names_[prediction_order[i]], 2);
+                number(prediction->values[prediction_order[i]]);
+            }
+            close('}', 1);
+        }
+
+        buffer_ += ',';
+        key("TimeStamp", 1);
+        string(timestamp(frame.timestamp));
+
+        close('}', 0);
+        return buffer_;
+    }
+
+private:
+    const char* const* event_names_;
+    std::string hardware_id_;
+    std::string buffer_;
+    bool pretty_ = false;
+
+    // * the timestamp only changes once per second, format it once
+    std::time_t cached_time_ = -1;
+    char cached_stamp_[32] = {0};
+
+    void indent(int level) {
+        if (pretty_) {
+            buffer_ += '\n';
+            buffer_.append(level * 4, ' ');
+        }
+    }
+
+    void key(const char* name, int level) {
+        indent(level);
+        string(name);
+        buffer_ += pretty_ ? ": " : ":";
+    }
+
+    void close(char c, int level) {
+        indent(level);
+        buffer_ += c;
+    }
+
+    void string(const char* value) {
+        buffer_ += '"';
+        for (const char* p = value; *p != '\0'; ++p) {
+            unsigned char c = static_cast<unsigned char>(*p);
+            switch (c) {
+                case '"':  buffer_ += "\\\""; break;
+                case '\\': buffer_ += "\\\\"; break;
+                case '\b': buffer_ += "\\b"; break;
+                case '\f': buffer_ += "\\f"; break;
+                case '\n': buffer_ += "\\n"; break;
+                case '\r': buffer_ += "\\r"; break;
+                case '\t': buffer_ += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        buffer_ += escaped;
+                    } else {
+                        buffer_ += static_cast<char>(c);
+                    }
+            }
+        }
+        buffer_ += '"';
+    }
+
+    void number(double value) {
+        if (!std::isfinite(value)) {
+            buffer_ += "null";
+            return;
+        }
+
+#if defined(__cpp_lib_to_chars)
+        // * shortest round-trip digits, laid out like nlohmann::json (fixed for 1e-4 < |v| < 1e15, else scientific)
+        char scientific[32];
+        char* end = std::to_chars(scientific, scientific + sizeof(scientific), value, std::chars_format::scientific).ptr;
+        const char* p = scientific;
+        if (*p == '-') {
+            buffer_ += '-';
+            ++p;
+        }
+        char digits[20];
+        int k = 0;
+        for (; p != end && *p != 'e'; ++p) {
+            if (*p != '.') digits[k++] = *p;
+        }
+        int exponent = 0;
+        bool negative = p + 1 != end && p[1] == '-';
+        for (p += 2; p < end; ++p) {
+            exponent = exponent * 10 + (*p - '0');
+        }
+        int n = (negative ? -exponent : exponent) + 1; // * position of the decimal point relative to the digits
+
+        if (k <= n && n <= 15) {
+            buffer_.append(digits, k);
+            buffer_.append(n - k, '0');
+            buffer_ += ".0";
+        } else if (0 < n && n <= 15) {
+            buffer_.append(digits, n);
+            buffer_ += '.';
+            buffer_.append(digits + n, k - n);
+        } else if (-4 < n && n <= 0) {
+            buffer_ += "0.";
+            buffer_.append(-n, '0');
+            buffer_.append(digits, k);
+        } else {
+            buffer_ += digits[0];
+            if (k > 1) {
+                buffer_ += '.';
+                buffer_.append(digits + 1, k - 1);
+            }
+            buffer_ += negative ? "e-" : "e+";
+            if (exponent < 10) buffer_ += '0';
+            buffer_ += std::to_string(exponent);
+        }
+#else
+        char digits[32];
+        int length = std::snprintf(digits, sizeof(digits), "%.17g", value);
+        buffer_.append(digits, length);
+        if (buffer_.find_first_of(".e", buffer_.size() - length) == std::string::npos) {
+            buffer_ += ".0";
+        }
+#endif
+    }
+
+    const char* timestamp(std::time_t t) {
+        if (t != cached_time_) {
+            std::tm tm;
+#if defined(_WIN32)
+            localtime_s(&tm, &t);
+#else
+            localtime_r(&t, &tm);
+#endif
+            std::strftime(cached_stamp_, sizeof(cached_stamp_), "%Y-%m-%d %H:%M:%S", &tm);
+            cached_time_ = t;
+        }
+        return cached_stamp_;
+    }
+};
+
+/**
+ * @brief A serialized message together with the snapshot it was built from.
+ */
+struct SensorPayload {
+    uint64_t frame_sequence;        // SensorFrame::sequence of the message
+    uint64_t prediction_sequence;   // PredictionFrame::sequence, 0 for the SAFE variant
+    std::string text;
+};
+
+/**
+ * @brief Serialize-once cache of the outgoing message, shared by all consumers.
+ *
+ * Each variant (SAFE / PREDICTION, compact / pretty) is serialized at most once per
+ * snapshot by whichever consumer asks first; everyone else gets the same immutable
+ * payload through a shared_ptr, so the cost does not grow with the number of
+ * consumers. The fast path is a single atomic shared_ptr load.
+ */
+class SensorPayloadCache {
+public:
+    /**
+     * @param event_names Event names indexed by SensorFrame::event.
+     * @param hardware_id Hardware id, read when the first payload is built.
+     */
+    SensorPayloadCache(const char* const* event_names, const std::string& hardware_id)
+        : event_names_(event_names), hardware_id_(hardware_id) {}
+
+    SensorPayloadCache(const SensorPayloadCache&) = delete;
+    SensorPayloadCache& operator=(const SensorPayloadCache&) = delete;
+
+    /**
+     * @brief Returns the message for a snapshot, serializing it only if no consumer did yet.
+     *
+     * @param frame The sensor sample.
+     * @param prediction The prediction to include (PREDICTION variant) or nullptr (SAFE variant).
+     * @param pretty true for the dump(4) layout used on the console.
+     * @return The shared payload, never nullptr.
+     */
+    std::shared_ptr<const SensorPayload> get(const SensorFrame& frame, const PredictionFrame* prediction, bool pretty = false) {
+        const int variant = (prediction != nullptr ? 1 : 0) + (pretty ? 2 : 0);
+        const uint64_t prediction_sequence = (prediction != nullptr) ? prediction->sequence : 0;
+
+        std::shared_ptr<const SensorPayload> payload = std::atomic_load(&payloads_[variant]);
+        if (payload != nullptr && payload->frame_sequence == frame.sequence && payload->prediction_sequence == prediction_sequence) {
+            return payload;
+        }
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        // * another consumer may have built it while we waited
+        payload = std::atomic_load(&payloads_[variant]);
+        if (payload != nullptr && payload->frame_sequence == frame.sequence && payload->prediction_sequence == prediction_sequence) {
+            return payload;
+        }
+        if (writer_ == nullptr) {
+            writer_.reset(new SensorFrameWriter(event_names_, hardware_id_));
+        }
+        std::shared_ptr<SensorPayload> built = std::make_shared<SensorPayload>();
+        built->frame_sequence = frame.sequence;
+        built->prediction_sequence = prediction_sequence;
+        built->text = writer_->write(frame, prediction, pretty);
+        std::atomic_store(&payloads_[variant], std::shared_ptr<const SensorPayload>(built));
+        return built;
+    }
+
+private:
+    const char* const* event_names_;
+    const std::string& hardware_id_;
+    std::mutex mtx_;
+    std::unique_ptr<SensorFrameWriter> writer_;
+    std::shared_ptr<const SensorPayload> payloads_[4];
+};
+
+#endif // SENSOR_FRAME_HPP
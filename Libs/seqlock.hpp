@@ -0,0 +1,85 @@
+#if !defined(SEQLOCK_HPP)
+#define SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <thread>
+
+/**
+ * @brief Single-writer sequence lock for small trivially copyable values.
+ *
+ * The writer never blocks: it bumps the sequence to odd, copies the value and
+ * bumps it back to even. Readers copy the value and retry if the sequence was odd
+ * or changed meanwhile, so they always get a consistent snapshot without taking a
+ * lock. The payload is kept in relaxed atomic words so concurrent copies are not
+ * data races.
+ *
+ * Only one thread may call store() for a given SeqLock.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() {
+        T value{};
+        store(value);
+    }
+
+    explicit SeqLock(const T& value) {
+        store(value);
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    void store(const T& value) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        uint64_t words[WORDS];
+        for (;;) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield(); // writer in progress
+                continue;
+            }
+            for (size_t i = 0; i < WORDS; ++i) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // Number of completed stores, readers can compare it to skip unchanged values
+    uint64_t version() const {
+        return sequence_.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> data_[WORDS];
+};
+
+#endif // SEQLOCK_HPP
@@ -0,0 +1,50 @@
+#if !defined(SEQUENCE_SIGNAL_HPP)
+#define SEQUENCE_SIGNAL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Wakes pipeline stages when a newer sequence number is published.
+ *
+ * The producer of a stage calls publish() after storing its result (for example in a
+ * SeqLock); consumers block in wait_newer() until a sequence greater than the last one
+ * they handled shows up, so they never poll or handle the same item twice. Only the
+ * number is passed, the data itself stays in the stage's own storage.
+ */
+class SequenceSignal {
+public:
+    SequenceSignal() = default;
+    SequenceSignal(const SequenceSignal&) = delete;
+    SequenceSignal& operator=(const SequenceSignal&) = delete;
+
+    void publish(uint64_t sequence) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            sequence_ = sequence;
+        }
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief Blocks until a sequence newer than last is published or the timeout expires.
+     *
+     * @param last The last sequence the caller handled.
+     * @param timeout Upper bound on the wait, lets callers check their stop flag.
+     * @return The latest published sequence (equal to last on timeout).
+     */
+    uint64_t wait_newer(uint64_t last, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait_for(lock, timeout, [&] { return sequence_ > last; });
+        return sequence_;
+    }
+
+private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    uint64_t sequence_ = 0;
+};
+
+#endif // SEQUENCE_SIGNAL_HPP
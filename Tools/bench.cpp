@@ -0,0 +1,547 @@
+/**
+ * @file bench.cpp
+ * @brief Inference microbenchmarks, results written as JSON for regression tracking.
+ *
+ * Usage: bench [model.json] [results.json]
+ *
+ * Measures:
+ * - Perceptron<float/double>::feedForward for several input widths.
+ * - Every activation type, per neuron (Perceptron) and vectorized (Kernels::activate),
+ *   sigmoid and tanh at every ActivationPrecision.
+ * - The max abs error of every sigmoid/tanh implementation against std::exp / std::tanh,
+ *   the run fails when one exceeds the bound documented on ActivationPrecision.
+ * - DenseNetwork predict latency on model.json, single sample and batched.
+ * - The int8 quantized model: dot kernel, predict latency and accuracy against double,
+ *   and every int8 layer alone on narrow input bands (the run fails past its bound).
+ * - fp16 / bf16 weight storage: dot kernel, predict latency and accuracy against double.
+ * - Model load time from model.json and from the binary model file.
+ *
+ * Each case is calibrated to run for about 50 ms, then repeated; the median and the
+ * fastest repeat are reported in ns per item (one neuron, one element or one sample).
+ *
+ * @section author Author
+ * Kidsadakorn Nuallaoong
+ **/
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <cmath>
+#include <nlohmann/json.hpp>
+#include "../Libs/Activation/Activation.hpp"
+#include "../Libs/Perceptron/Perceptron.hpp"
+#include "../Libs/Dense/Dense.hpp"
+#include "../Libs/Kernels/Kernels.hpp"
+#include "../Libs/Quantized/Quantized.hpp"
+#include "../Libs/Half/Half.hpp"
+
+struct BenchResult
+{
+    std::string name;
+    nlohmann::json params;
+    double nsPerItem;       // * median of the repeats
+    double minNsPerItem;    // * fastest repeat
+    double itemsPerSecond;
+    size_t iterations;      // * calls per repeat
+    int repeats;
+};
+
+// * keeps the compiler from discarding benchmarked results
+template <typename V>
+inline void doNotOptimize(const V& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+class Bench
+{
+    public:
+        std::vector<BenchResult> results;
+
+        /**
+         * @brief Runs fn repeatedly and records the time per item.
+         *
+         * @param items Items processed by one call of fn (neurons, elements, samples).
+         */
+        template <typename F>
+        void run(const std::string& name, const nlohmann::json& params, F fn, size_t items = 1)
+        {
+            typedef std::chrono::steady_clock clock;
+            const double target = 0.05; // * seconds per repeat
+            const int repeats = 5;
+
+            // * calibrate, doubling until one batch takes a measurable time
+            size_t iterations = 1;
+            for (;;) {
+                clock::time_point start = clock::now();
+                for (size_t i = 0; i < iterations; ++i) fn();
+                double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+                if (elapsed >= target / 4 || iterations >= (size_t(1) << 30)) {
+                    if (elapsed > 0) {
+                        iterations = std::max<size_t>(1, size_t(iterations * target / elapsed));
+                    }
+                    break;
+                }
+                iterations *= 2;
+            }
+
+            std::vector<double> samples;
+            for (int r = 0; r < repeats; ++r) {
+                clock::time_point start = clock::now();
+                for (size_t i = 0; i < iterations; ++i) fn();
+                double elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+                samples.push_back(elapsed / (double(iterations) * items));
+            }
+            std::sort(samples.begin(), samples.end());
+
+            BenchResult result;
+            result.name = name;
+            result.params = params;
+            result.nsPerItem = samples[samples.size() / 2];
+            result.minNsPerItem = samples.front();
+            result.itemsPerSecond = 1e9 / result.nsPerItem;
+            result.iterations = iterations;
+            result.repeats = repeats;
+            results.push_back(result);
+
+            std::cout << std::left << std::setw(28) << name << std::setw(64) << params.dump()
+                      << std::right << std::setw(12) << std::fixed << std::setprecision(2) << result.nsPerItem << " ns/item"
+                      << std::setw(16) << std::setprecision(0) << result.itemsPerSecond << " items/s" << std::endl;
+        }
+
+        nlohmann::json toJson() const
+        {
+            nlohmann::json list = nlohmann::json::array();
+            for (const BenchResult& r : results) {
+                list.push_back({
+                    {"name", r.name},
+                    {"params", r.params},
+                    {"ns_per_item", r.nsPerItem},
+                    {"min_ns_per_item", r.minNsPerItem},
+                    {"items_per_second", r.itemsPerSecond},
+                    {"iterations", r.iterations},
+                    {"repeats", r.repeats}
+                });
+            }
+            return list;
+        }
+};
+
+template <typename T>
+const char* typeName();
+template <> const char* typeName<float>() { return "float"; }
+template <> const char* typeName<double>() { return "double"; }
+
+template <typename T>
+vector<T> randomVector(size_t n, std::mt19937& gen)
+{
+    std::uniform_real_distribution<double> dis(-1.0, 1.0);
+    vector<T> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = T(dis(gen));
+    return v;
+}
+
+template <typename T>
+void benchPerceptron(Bench& bench, std::mt19937& gen)
+{
+    const int widths[] = {4, 16, 64, 256, 1024};
+    for (int width : widths) {
+        Perceptron<T> p(width);
+        p.setWeights(randomVector<T>(width, gen));
+        p.typeActivation(SIGMOID);
+        vector<T> inputs = randomVector<T>(width, gen);
+        bench.run("perceptron_feedforward", {{"type", typeName<T>()}, {"width", width}, {"activation", "sigmoid"}},
+                  [&]() { doNotOptimize(p.feedForward(inputs)); });
+    }
+
+    // * one neuron per activation, the activation is a per-call pointer dispatch
+    const int width = 64;
+    for (int a = LINEAR; a <= STEP; ++a) {
+        ActivationType type = static_cast<ActivationType>(a);
+        if (type == SOFTMAX) {
+            continue; // * only defined over a whole layer, covered by kernels_activate
+        }
+        for (int pr = PRECISION_EXACT; pr <= PRECISION_TABLE; ++pr) {
+            ActivationPrecision precision = static_cast<ActivationPrecision>(pr);
+            if (precision != PRECISION_EXACT && type != SIGMOID && type != TANH) {
+                continue;
+            }
+            Perceptron<T> p(width);
+            p.setWeights(randomVector<T>(width, gen));
+            p.typeActivation(type);
+            p.setActivationPrecision(precision);
+            vector<T> inputs = randomVector<T>(width, gen);
+            bench.run("perceptron_activation", {{"type", typeName<T>()}, {"width", width}, {"activation", activationName(type)},
+                                                {"precision", activationPrecisionName(precision)}},
+                      [&]() { doNotOptimize(p.feedForward(inputs)); });
+        }
+    }
+}
+
+template <typename T>
+void benchKernels(Bench& bench, std::mt19937& gen)
+{
+    const size_t n = 1024;
+    vector<T> source = randomVector<T>(n, gen);
+    vector<T> data(n);
+    for (int a = LINEAR; a <= STEP; ++a) {
+        ActivationType type = static_cast<ActivationType>(a);
+        for (int pr = PRECISION_EXACT; pr <= PRECISION_TABLE; ++pr) {
+            ActivationPrecision precision = static_cast<ActivationPrecision>(pr);
+            if (precision != PRECISION_EXACT && type != SIGMOID && type != TANH) {
+                continue;
+            }
+            bench.run("kernels_activate", {{"type", typeName<T>()}, {"n", n}, {"activation", activationName(type)},
+                                           {"precision", activationPrecisionName(precision)}, {"backend", Kernels<T>::backend()}},
+                      [&]() {
+                          std::copy(source.begin(), source.end(), data.begin());
+                          Kernels<T>::activate(type, data.data(), n, precision);
+                          doNotOptimize(data[0]);
+                      }, n);
+        }
+    }
+
+    vector<T> other = randomVector<T>(n, gen);
+    bench.run("kernels_dot", {{"type", typeName<T>()}, {"n", n}, {"backend", Kernels<T>::backend()}},
+              [&]() { doNotOptimize(Kernels<T>::dot(source.data(), other.data(), n)); }, n);
+}
+
+/**
+ * @brief Measures the max abs error of every sigmoid/tanh implementation against double std::exp / std::tanh.
+ *
+ * Inputs cover [-40, 40] in steps of 1/256 plus the infinities, both through the scalar
+ * functions (Activation::resolve, used by Perceptron) and the vectorized kernels.
+ *
+ * @param failed Set when an approximation exceeds the bound documented on ActivationPrecision.
+ */
+template <typename T>
+nlohmann::json checkActivationAccuracy(bool& failed)
+{
+    vector<T> inputs;
+    for (int i = -40 * 256; i <= 40 * 256; ++i) {
+        inputs.push_back(T(i / 256.0));
+    }
+    inputs.push_back(std::numeric_limits<T>::infinity());
+    inputs.push_back(-std::numeric_limits<T>::infinity());
+
+    nlohmann::json list = nlohmann::json::array();
+    const ActivationType types[] = {SIGMOID, TANH};
+    for (ActivationType type : types) {
+        vector<double> expected(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            double x = (double)inputs[i];
+            expected[i] = type == SIGMOID ? 1.0 / (1.0 + std::exp(-x)) : std::tanh(x);
+        }
+
+        for (int pr = PRECISION_EXACT; pr <= PRECISION_TABLE; ++pr) {
+            ActivationPrecision precision = static_cast<ActivationPrecision>(pr);
+            // * bounds from the ActivationPrecision documentation, sigmoid halves the tanh error
+            double bound = precision == PRECISION_RATIONAL ? 4e-7 : precision == PRECISION_TABLE ? 6e-6 : 1e-6;
+            if (type == SIGMOID) {
+                bound /= 2;
+            }
+
+            typename Activation<T>::Function fn = Activation<T>::resolve(type, precision);
+            vector<T> vectorized(inputs);
+            Kernels<T>::activate(type, vectorized.data(), vectorized.size(), precision);
+
+            double scalarError = 0;
+            double kernelError = 0;
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                scalarError = std::max(scalarError, std::fabs((double)fn(inputs[i]) - expected[i]));
+                kernelError = std::max(kernelError, std::fabs((double)vectorized[i] - expected[i]));
+            }
+            bool within = scalarError <= bound && kernelError <= bound;
+            failed = failed || !within;
+
+            std::cout << std::left << std::setw(28) << "activation_accuracy"
+                      << typeName<T>() << " " << activationName(type) << " " << activationPrecisionName(precision)
+                      << ": scalar " << std::scientific << std::setprecision(2) << scalarError
+                      << ", " << Kernels<T>::backend() << " " << kernelError << " (bound " << bound << ")"
+                      << (within ? "" : " \033[1;31mEXCEEDED\033[0m") << std::defaultfloat << std::endl;
+            list.push_back({
+                {"type", typeName<T>()},
+                {"activation", activationName(type)},
+                {"precision", activationPrecisionName(precision)},
+                {"backend", Kernels<T>::backend()},
+                {"scalar_max_abs_error", scalarError},
+                {"kernel_max_abs_error", kernelError},
+                {"bound", bound},
+                {"within_bound", within}
+            });
+        }
+    }
+    return list;
+}
+
+template <typename T>
+void benchModel(Bench& bench, const std::string& modelPath, const std::string& binaryPath, std::mt19937& gen)
+{
+    DenseNetwork<T> network;
+    network.import_from_json(modelPath);
+    const size_t in = network.inputSize();
+    const size_t out = network.outputSize();
+
+    vector<T> sample = randomVector<T>(in, gen);
+    vector<T> result(out);
+    bench.run("model_predict", {{"type", typeName<T>()}, {"batch", 1}},
+              [&]() {
+                  network.predict(sample.data(), result.data());
+                  doNotOptimize(result[0]);
+              });
+
+    const size_t batches[] = {16, 64, 256};
+    for (size_t batch : batches) {
+        vector<T> inputs = randomVector<T>(in * batch, gen);
+        vector<T> outputs(out * batch);
+        bench.run("model_predict", {{"type", typeName<T>()}, {"batch", batch}},
+                  [&]() {
+                      network.predictBatch(inputs.data(), batch, outputs.data());
+                      doNotOptimize(outputs[0]);
+                  }, batch);
+    }
+
+    bench.run("model_load_json", {{"type", typeName<T>()}},
+              [&]() {
+                  DenseNetwork<T> loaded;
+                  loaded.import_from_json(modelPath);
+                  doNotOptimize(loaded.layers.size());
+              });
+
+    network.export_to_binary(binaryPath);
+    bench.run("model_load_binary", {{"type", typeName<T>()}},
+              [&]() {
+                  DenseNetwork<T> loaded;
+                  loaded.import_from_binary(binaryPath);
+                  doNotOptimize(loaded.layers.size());
+              });
+    std::remove(binaryPath.c_str());
+}
+
+// * same calibration as MODEL_ENGINE=int8/fp16/bf16 in the application: inputs uniform over 0..100
+vector<vector<double>> calibrationSet(size_t inputs, std::mt19937& gen)
+{
+    std::uniform_real_distribution<double> range(0.0, 100.0);
+    vector<vector<double>> calibration(1000, vector<double>(inputs));
+    for (vector<double>& sample : calibration) {
+        for (double& value : sample) value = range(gen);
+    }
+    return calibration;
+}
+
+/**
+ * @brief Drives every int8 layer alone with inputs in narrow bands, including far from 0.
+ *
+ * Saturated sigmoid outputs ([0.99999, 1]) and steady sensor readings ([95, 96]) once
+ * pushed the input zero point out of int8 and overflowed the int32 correction. Outputs are
+ * compared before the activation; the run fails when a band exceeds six sigma of the int8
+ * rounding error.
+ */
+nlohmann::json checkInt8LayerAccuracy(const std::string& modelPath, std::mt19937& gen, bool& failed)
+{
+    struct Band { const char* name; double lo; double hi; };
+    const Band bands[] = {{"sensor", 0.0, 100.0}, {"saturated", 0.99999, 1.0}, {"steady", 95.0, 96.0}};
+
+    DenseNetwork<double> reference;
+    reference.import_from_json(modelPath);
+
+    nlohmann::json list = nlohmann::json::array();
+    for (size_t l = 0; l < reference.layers.size(); ++l) {
+        // * compared before the activation, a saturating one would hide the error
+        DenseLayer<double> layer = reference.layers[l];
+        layer.typeActivation(LINEAR);
+        QuantizedLayer quantized;
+        quantized.quantize(layer);
+
+        for (const Band& band : bands) {
+            std::uniform_real_distribution<double> range(band.lo, band.hi);
+            vector<double> inputs(layer.inputSize);
+            vector<double> expected(layer.outputSize);
+            vector<float> converted(layer.inputSize);
+            vector<int8_t> scratch(layer.inputSize);
+            vector<float> actual(layer.outputSize);
+            double maxError = 0;
+            double bound = 0;
+            for (int sample = 0; sample < 200; ++sample) {
+                for (int i = 0; i < layer.inputSize; ++i) {
+                    inputs[i] = range(gen);
+                    converted[i] = (float)inputs[i];
+                }
+                layer.forward(inputs.data(), expected.data());
+                quantized.forward(converted.data(), scratch.data(), actual.data());
+                for (int o = 0; o < layer.outputSize; ++o) {
+                    maxError = std::max(maxError, std::fabs((double)actual[o] - expected[o]));
+                }
+            }
+            // * rounding errors are independent and uniform over one step (sigma = step / sqrt(12)),
+            // * the bound is six sigma of their sum over a row
+            double inputStep = (std::max(band.hi, 0.0) - std::min(band.lo, 0.0)) / 254.0;
+            double largestInput = std::max(std::fabs(band.lo), std::fabs(band.hi));
+            for (int o = 0; o < layer.outputSize; ++o) {
+                const double* row = layer.weightData() + (size_t)o * layer.inputSize;
+                double squares = 0;
+                double rowMax = 0;
+                for (int i = 0; i < layer.inputSize; ++i) {
+                    squares += row[i] * row[i];
+                    rowMax = std::max(rowMax, std::fabs(row[i]));
+                }
+                double weightStep = rowMax / 127.0;
+                double variance = (squares * inputStep * inputStep +
+                                   layer.inputSize * largestInput * largestInput * weightStep * weightStep) / 12.0;
+                bound = std::max(bound, 6.0 * std::sqrt(variance));
+            }
+            bool within = maxError <= bound;
+            failed = failed || !within;
+
+            std::cout << std::left << std::setw(28) << "int8_layer_accuracy"
+                      << "layer " << l << " " << band.name << ": " << std::scientific << std::setprecision(2) << maxError
+                      << " (bound " << bound << ")" << (within ? "" : " \033[1;31mEXCEEDED\033[0m") << std::defaultfloat << std::endl;
+            list.push_back({
+                {"type", "int8"},
+                {"layer", l},
+                {"inputs", band.name},
+                {"max_abs_error", maxError},
+                {"bound", bound},
+                {"within_bound", within}
+            });
+        }
+    }
+    return list;
+}
+
+void benchInt8(Bench& bench, const std::string& modelPath, std::mt19937& gen)
+{
+    const size_t n = 1024;
+    std::uniform_int_distribution<int> dis(-127, 127);
+    vector<int8_t> a(n);
+    vector<int8_t> b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = (int8_t)dis(gen);
+        b[i] = (int8_t)dis(gen);
+    }
+    bench.run("kernels_dot", {{"type", "int8"}, {"n", n}, {"backend", KernelsInt8::backend()}},
+              [&]() { doNotOptimize(KernelsInt8::dot(a.data(), b.data(), n)); }, n);
+
+    DenseNetwork<double> reference;
+    reference.import_from_json(modelPath);
+    QuantizedNetwork network;
+    network.quantize(reference);
+
+    QuantizationReport report = network.evaluate(reference, calibrationSet(network.inputSize(), gen));
+
+    // * timed on the same input distribution as model_predict, so the engines are comparable
+    vector<double> sample = randomVector<double>(network.inputSize(), gen);
+    vector<double> result(network.outputSize());
+    bench.run("model_predict", {{"type", "int8"}, {"batch", 1}, {"weight_bytes", network.weightBytes()},
+                                {"max_abs_error", report.maxAbsError}, {"mean_abs_error", report.meanAbsError},
+                                {"top1_agreement", report.top1Agreement}},
+              [&]() {
+                  network.predict(sample.data(), result.data());
+                  doNotOptimize(result[0]);
+              });
+}
+
+void benchHalf(Bench& bench, const std::string& modelPath, std::mt19937& gen)
+{
+    const HalfFormat formats[] = {HALF_FP16, HALF_BF16};
+    const char* names[] = {"fp16", "bf16"};
+
+    const size_t n = 1024;
+    vector<float> x = randomVector<float>(n, gen);
+    vector<float> w = randomVector<float>(n, gen);
+    for (HalfFormat format : formats) {
+        vector<uint16_t> h(n);
+        KernelsHalf::narrow(format, w.data(), n, h.data());
+        bench.run("kernels_dot", {{"type", names[format]}, {"n", n}, {"backend", KernelsHalf::backend()}},
+                  [&]() { doNotOptimize(KernelsHalf::dot(format, h.data(), x.data(), n)); }, n);
+    }
+
+    DenseNetwork<double> reference;
+    reference.import_from_json(modelPath);
+    vector<vector<double>> calibration = calibrationSet(reference.inputSize(), gen);
+    for (HalfFormat format : formats) {
+        HalfNetwork network;
+        network.convert(reference, format);
+        QuantizationReport report = network.evaluate(reference, calibration);
+
+        vector<double> sample = randomVector<double>(network.inputSize(), gen);
+        vector<double> result(network.outputSize());
+        bench.run("model_predict", {{"type", names[format]}, {"batch", 1}, {"weight_bytes", network.weightBytes()},
+                                    {"max_abs_error", report.maxAbsError}, {"mean_abs_error", report.meanAbsError},
+                                    {"top1_agreement", report.top1Agreement}},
+                  [&]() {
+                      network.predict(sample.data(), result.data());
+                      doNotOptimize(result[0]);
+                  });
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string modelPath = argc > 1 ? argv[1] : "model.json";
+    std::string outputPath = argc > 2 ? argv[2] : "bench_results.json";
+    std::string binaryPath = outputPath + ".model.tmp";
+
+    std::mt19937 gen(42);
+    Bench bench;
+    bool inaccurate = false;
+    nlohmann::json accuracy = checkActivationAccuracy<float>(inaccurate);
+    for (const auto& entry : checkActivationAccuracy<double>(inaccurate)) {
+        accuracy.push_back(entry);
+    }
+    try {
+        for (const auto& entry : checkInt8LayerAccuracy(modelPath, gen, inaccurate)) {
+            accuracy.push_back(entry);
+        }
+        benchPerceptron<float>(bench, gen);
+        benchPerceptron<double>(bench, gen);
+        benchKernels<float>(bench, gen);
+        benchKernels<double>(bench, gen);
+        benchModel<float>(bench, modelPath, binaryPath, gen);
+        benchModel<double>(bench, modelPath, binaryPath, gen);
+        benchInt8(bench, modelPath, gen);
+        benchHalf(bench, modelPath, gen);
+    } catch (const std::exception& e) {
+        std::cerr << "\033[1;31mBenchmark failed: " << e.what() << "\033[0m" << std::endl;
+        return 1;
+    }
+
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    nlohmann::json report = {
+        {"timestamp", stamp},
+        {"model", modelPath},
+        {"kernels_backend", {{"float", Kernels<float>::backend()}, {"double", Kernels<double>::backend()}, {"int8", KernelsInt8::backend()}, {"half", KernelsHalf::backend()}}},
+#if defined(__VERSION__)
+        {"compiler", __VERSION__},
+#endif
+        {"activation_accuracy", accuracy},
+        {"results", bench.toJson()}
+    };
+
+    std::ofstream out(outputPath);
+    if (!out) {
+        std::cerr << "\033[1;31mUnable to write " << outputPath << "\033[0m" << std::endl;
+        return 1;
+    }
+    out << report.dump(4) << std::endl;
+    std::cout << "Results written to " << outputPath << std::endl;
+    if (inaccurate) {
+        std::cerr << "\033[1;31mAn activation approximation or int8 layer exceeds its error bound\033[0m" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file log_decode.cpp
+ * @brief Renders a binary log file written by LogManager (BINARY format) as text.
+ *
+ * Usage: log_decode <activity.log.bin> [output.log]
+ *
+ * Lines have the text sink layout plus milliseconds and the logging thread:
+ * [2024-11-05 12:00:00.123] [INFO] [T3] message
+ * Without an output file the text goes to stdout.
+ *
+ * @section author Author
+ * Kidsadakorn Nuallaoong
+ **/
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include "../Libs/log_manager.hpp"
+
+class Reader {
+public:
+    explicit Reader(std::istream& in) : in_(in) {}
+
+    template <typename V>
+    bool get(V& value) {
+        return static_cast<bool>(in_.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool text(std::string& value, uint32_t length) {
+        value.resize(length);
+        return length == 0 || static_cast<bool>(in_.read(&value[0], length));
+    }
+
+private:
+    std::istream& in_;
+};
+
+std::string format_time(int64_t wall_ns) {
+    std::time_t seconds = static_cast<std::time_t>(wall_ns / 1000000000);
+    int millis = static_cast<int>((wall_ns / 1000000) % 1000);
+    std::tm tm;
+#if defined(_WIN32)
+    localtime_s(&tm, &seconds);
+#else
+    localtime_r(&seconds, &tm);
+#endif
+    char buf[48];
+    size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    std::snprintf(buf + n, sizeof(buf) - n, ".%03d", millis);
+    return buf;
+}
+
+int decode(std::istream& in, std::ostream& out) {
+    LogFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::strncmp(header.magic, LOG_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "\033[1;31mNot a binary log file\033[0m" << std::endl;
+        return 1;
+    }
+    if (header.version != LOG_FILE_VERSION) {
+        std::cerr << "\033[1;31mUnsupported log file version: " << header.version << "\033[0m" << std::endl;
+        return 1;
+    }
+
+    Reader reader(in);
+    std::unordered_map<uint32_t, std::string> strings;
+    int64_t wall_origin = 0;
+    uint64_t mono_origin = 0;
+    size_t events = 0;
+    std::string text;
+
+    uint8_t type;
+    while (reader.get(type)) {
+        bool ok = true;
+        if (type == LOG_RECORD_SESSION) {
+            ok = reader.get(wall_origin) && reader.get(mono_origin);
+            strings.clear();
+        } else if (type == LOG_RECORD_STRING) {
+            uint32_t id, length;
+            ok = reader.get(id) && reader.get(length) && reader.text(strings[id], length);
+        } else if (type == LOG_RECORD_EVENT) {
+            uint8_t level;
+            uint32_t thread, id, length;
+            uint64_t time;
+            ok = reader.get(level) && reader.get(thread) && reader.get(id) && reader.get(time) &&
+                 reader.get(length) && reader.text(text, length);
+            if (ok) {
+                int64_t wall = wall_origin + static_cast<int64_t>(time - mono_origin);
+                out << '[' << format_time(wall) << "] [" << LogManager::getLogLevelString(static_cast<LogManager::LogLevel>(level))
+                    << "] [T" << thread << "] " << (id != 0 ? strings[id] : text) << '\n';
+                ++events;
+            }
+        } else {
+            std::cerr << "\033[1;31mUnknown record type " << static_cast<int>(type) << " after " << events << " events\033[0m" << std::endl;
+            return 1;
+        }
+        if (!ok) {
+            // * the writer may have been stopped mid-record, keep what was decoded
+            std::cerr << "Truncated record after " << events << " events" << std::endl;
+            break;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <activity.log.bin> [output.log]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "\033[1;31mUnable to open " << argv[1] << "\033[0m" << std::endl;
+        return 1;
+    }
+    if (argc > 2) {
+        std::ofstream out(argv[2]);
+        if (!out) {
+            std::cerr << "\033[1;31mUnable to write " << argv[2] << "\033[0m" << std::endl;
+            return 1;
+        }
+        return decode(in, out);
+    }
+    return decode(in, std::cout);
+}
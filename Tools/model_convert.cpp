@@ -0,0 +1,50 @@
+/**
+ * @file model_convert.cpp
+ * @brief Converts a model.json into the binary model file loaded by DenseNetwork::import_from_binary.
+ * 
+ * Usage: model_convert <model.json> <model.bin> [float|double]
+ * 
+ * The optional dtype selects the precision of the stored weights (default: double,
+ * which is what Ai_handle runs).
+ * 
+ * @section author Author
+ * Kidsadakorn Nuallaoong
+ **/
+#include <iostream>
+#include <string>
+#include "../Libs/Dense/Dense.hpp"
+
+template <typename T>
+int convert(const std::string& input, const std::string& output)
+{
+    DenseNetwork<T> network;
+    network.import_from_json(input);
+    network.export_to_binary(output);
+
+    // * load it back to make sure the file is usable
+    DenseNetwork<T> check;
+    check.import_from_binary(output);
+    std::cout << "Converted " << input << " -> " << output << " (" << check.layers.size() << " layers, "
+              << check.inputSize() << " inputs, " << check.outputSize() << " outputs)" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <model.json> <model.bin> [float|double]" << std::endl;
+        return 1;
+    }
+
+    std::string dtype = argc > 3 ? argv[3] : "double";
+    try {
+        if (dtype == "float") {
+            return convert<float>(argv[1], argv[2]);
+        } else if (dtype == "double") {
+            return convert<double>(argv[1], argv[2]);
+        }
+        std::cerr << "Unknown dtype: " << dtype << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+    return 1;
+}
@@ -34,15 +34,28 @@
 #include <cstdlib>
 #include <unordered_map>
 #include <iomanip>
+#include <memory>
+#include <atomic>
+#include <sys/stat.h>
 #include <nlohmann/json.hpp>
 #include <websocketpp/client.hpp>
+#include <websocketpp/server.hpp>
 #include <websocketpp/config/asio_client.hpp>
 #include <websocketpp/common/thread.hpp>
 #include <websocketpp/config/asio.hpp>
+#include <websocketpp/config/asio_no_tls.hpp>
 #include <boost/asio/ssl/context.hpp>
 #include "Libs/log_manager.hpp"
-#include "Libs/MLP/MLP.hpp"
+#include "Libs/Dense/Dense.hpp"
+#include "Libs/Quantized/Quantized.hpp"
+#include "Libs/Half/Half.hpp"
+#include "Libs/Kernels/Kernels.hpp"
 #include "Libs/http_helper.hpp"
+#include "Libs/seqlock.hpp"
+#include "Libs/sensor_frame.hpp"
+#include "Libs/sequence_signal.hpp"
+#include "Libs/pipeline_probe.hpp"
+#include "Libs/metrics.hpp"
 
 // * Enum for operating mode
 enum mode {SAFE_MODE, PREDICTION_MODE};
@@ -125,14 +138,16 @@ typedef websocketpp::client<websocketpp::config::asio_client> client;
 
 typedef websocketpp::client<websocketpp::config::asio_tls_client> tls_client;
 
+// * Plain HTTP/WebSocket server for local endpoints (metrics scrape, --bench stand-in)
+typedef websocketpp::server<websocketpp::config::asio> local_server;
+
 // * Global log manager instance
 LogManager& logManager = LogManager::getInstance();
 
-// * Global mutex for thread safety
-std::mutex mtx;
-
-// * HTTP client
-HTTP http;
+// * HTTP client, every request runs on its single event loop thread
+AsyncHTTP http;
+// * Timeout for control-plane requests, a slow server must not stall mode/speed updates
+const long http_timeout_ms = 2000;
 std::string rest_main_server_cstr = "http://localhost:8181";
 
 // * Random number generator for sensor data simulation
@@ -142,32 +157,41 @@ std::uniform_real_distribution<> dis(0.0, 100.0);
 
 // * Event types for sensor data
 const char* Event[] = {"Cold", "Warm", "Hot", "Dry", "Wet", "Normal", "Unknown"};
+// * Set (uppercased) by main before the worker threads start, read-only afterwards
 std::string HardwareID = "UNKNOWn";
 
-// * JSON structure holding initial sensor data
-nlohmann::json sensor_data = {
-    {"TimeStamp", "2023-10-05 12:00:00"},
-    {"HardwareID", HardwareID},
-    {"Event", "Cold"},
-    {"Mode", (current_mode == PREDICTION_MODE) ? "PREDCITION" : "SAFE"},
-    {"Data", {
-        {"CO2", dis(gen)},
-        {"VOC", dis(gen)},
-        {"RA", dis(gen)},
-        {"TEMP", dis(gen)},
-        {"HUMID", dis(gen)},
-        {"PRESSURE", dis(gen)}
-    }},
-    {"Prediction", {
-        {"Cold", 0.0},
-        {"Warm", 0.0},
-        {"Hot", 0.0},
-        {"Dry", 0.0},
-        {"Wet", 0.0},
-        {"Normal", 0.0},
-        {"Unknown", 0.0}
-    }}
-};
+// * Latest sensor sample (written by update_json_loop) and the same sample with its prediction
+// * (written by Ai_handle). Each has a single writer; readers take lock-free consistent snapshots.
+SeqLock<SensorFrame> sensor_frame;
+SeqLock<PublishedFrame> published_frame;
+// * Pipeline: update_json_loop -> sensor_ready -> Ai_handle -> publish_ready -> print_json / send loops.
+// * Each stage sleeps until the previous one has something new and skips sequences it already
+// * handled, so nothing is sent or predicted twice; a stage that falls behind skips to the latest.
+SequenceSignal sensor_ready;
+SequenceSignal publish_ready;
+// * Upper bound on a stage wait, only so the threads notice is_run going false
+const std::chrono::milliseconds stage_wait_timeout(100);
+// * Detached send threads still running, the client they send on must outlive them
+std::atomic<int> send_threads_running(0);
+// * Serialized messages, built once per snapshot and shared by print_json and the send loops
+SensorPayloadCache payload_cache(Event, HardwareID);
+// * Sample-to-send latency and per-thread CPU, only recording while the --bench mode runs
+PipelineProbe pipeline_probe;
+
+// * Operational metrics, scraped from http://127.0.0.1:METRICS_PORT/metrics
+Metrics& metrics = Metrics::getInstance();
+MetricCounter& frames_sampled = metrics.counter("edge_frames_sampled_total", "Sensor frames sampled");
+MetricCounter& messages_sent = metrics.counter("edge_messages_sent_total", "Sensor frames handed to the WebSocket");
+MetricCounter& message_bytes_sent = metrics.counter("edge_message_bytes_sent_total", "Bytes of sensor frames handed to the WebSocket");
+MetricCounter& send_errors = metrics.counter("edge_send_errors_total", "Sensor frames the WebSocket failed to send");
+MetricGauge& ws_buffered_bytes = metrics.gauge("edge_ws_buffered_bytes", "Bytes queued on the WebSocket connection, not written to the socket yet");
+MetricHistogram& prediction_duration = metrics.histogram("edge_prediction_duration_seconds", "Model inference time per frame");
+MetricHistogram& model_load_duration = metrics.histogram("edge_model_load_duration_seconds", "Time to load the model from disk");
+MetricCounter& model_load_failures = metrics.counter("edge_model_load_failures_total", "Model loads that failed");
+MetricCounter& model_reloads = metrics.counter("edge_model_reloads_total", "Models swapped in while running");
+MetricHistogram& hardware_poll_duration = metrics.histogram("edge_hardware_poll_duration_seconds", "Fallback /hardware poll time");
+MetricCounter& hardware_poll_failures = metrics.counter("edge_hardware_poll_failures_total", "Fallback /hardware polls that failed");
+MetricCounter& control_messages = metrics.counter("edge_control_messages_total", "Control frames received over the WebSocket");
 
 enum speed {SLOW, MEDIUM, FAST};
 speed current_speed = SLOW;
@@ -187,34 +211,25 @@ void delay(){
 void delay_server(){ std::this_thread::sleep_for(std::chrono::seconds(1)); }
 
 // * Function to update sensor data with new Arandom values
-void update_sensor_data(nlohmann::json& j) {
-    std::lock_guard<std::mutex> lock(mtx);
-    // * update timestamp
-    std::time_t t = std::time(nullptr);
-    std::tm tm = *std::localtime(&t);
-    std::stringstream ss;
-    ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    j["TimeStamp"] = ss.str();
-    // * update data
-    std::uniform_int_distribution<> hardware_dist(0, sizeof(HardwareID)/sizeof(HardwareID[0]) - 1);
+void update_sensor_data(SensorFrame& frame) {
     std::uniform_int_distribution<> event_dist(0, sizeof(Event)/sizeof(Event[0]) - 1);
-    j["HardwareID"] = HardwareID;
-    j["Event"] = Event[event_dist(gen)];
-    j["Mode"] = (current_mode == PREDICTION_MODE) ? "PREDICTION" : "SAFE";
-    j["Data"]["CO2"] = dis(gen);
-    j["Data"]["VOC"] = dis(gen);
-    j["Data"]["RA"] = dis(gen);
-    j["Data"]["TEMP"] = dis(gen);
-    j["Data"]["HUMID"] = dis(gen);
-    j["Data"]["PRESSURE"] = dis(gen);
+    frame.sequence += 1;
+    frame.timestamp = std::time(nullptr);
+    frame.event = event_dist(gen);
+    frame.mode = current_mode;
+    frame.co2 = dis(gen);
+    frame.voc = dis(gen);
+    frame.ra = dis(gen);
+    frame.temp = dis(gen);
+    frame.humid = dis(gen);
+    frame.pressure = dis(gen);
 
     // Log the updated sensor data
-    // logManager.setLogLevel(LogManager::DEBUG);
-    // logManager.log(LogManager::DEBUG, "Sensor data updated");
+    // LOG_MSG(DEBUG, "Sensor data updated");
 }
 
+// * info is only touched by the update thread
 void update_info(nlohmann::json& j) {
-    std::lock_guard<std::mutex> lock(mtx);
     j["HardwareID"] = HardwareID;
     j["Mode"] = (current_mode == PREDICTION_MODE) ? "PREDICTION" : "SAFE";
     j["Speed"] = (current_speed == SLOW) ? "SLOW" : (current_speed == MEDIUM) ? "MEDIUM" : "FAST";
@@ -224,63 +239,69 @@ void update_info(nlohmann::json& j) {
  * @brief Prints the sensor data JSON to the console.
  * 
  * This function prints the sensor data JSON to the console.
- * It acquires a lock on the mutex to ensure thread safety.
+ * It wakes on publish_ready and reads a lock-free snapshot of the latest sample with its prediction.
  * 
  * @note This function is intended to be run in a separate thread.
  **/
 void print_json() {
+    PipelineProbe::ThreadScope probe_scope(pipeline_probe, "print_json");
     std::cout << "Starting print_json thread" << std::endl;
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Starting print json thread");
+    LOG_STATIC(DEBUG, "Starting print json thread");
 
+    uint64_t last = 0;
     while (is_run) {
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            // * if safe mode dump json but not dump prediction
-            if (current_mode == SAFE_MODE) {
-                nlohmann::json safe_mode_data = sensor_data;
-                safe_mode_data.erase("Prediction");
-                std::cout << safe_mode_data.dump(4) << std::endl;
-            } else {
-                std::cout << sensor_data.dump(4) << std::endl;
-            }
+        uint64_t ready = publish_ready.wait_newer(last, stage_wait_timeout);
+        if (ready == last) {
+            continue;
         }
-        delay();
+        // * the frame and its prediction come from one snapshot, at least as new as ready
+        PublishedFrame published = published_frame.load();
+        last = published.sensor.sequence;
+        const SensorFrame& frame = published.sensor;
+        // * if safe mode dump json but not dump prediction
+        const PredictionFrame& prediction = published.prediction;
+        std::cout << payload_cache.get(frame, (frame.mode == SAFE_MODE) ? nullptr : &prediction, true)->text << std::endl;
     }
 
     std::cout << "Exiting print_json thread" << std::endl;
-    logManager.setLogLevel(LogManager::INFO);
-    logManager.log(LogManager::INFO, "Exiting print json thread");
+    LOG_STATIC(INFO, "Exiting print json thread");
 }
 
 /**
- * @brief Updates the sensor data JSON with new random values.
+ * @brief Updates the sensor data with new random values.
  * 
- * This function updates the sensor data JSON with new random values.
- * It acquires a lock on the mutex to ensure thread safety.
+ * This function samples new random values and publishes them as the latest SensorFrame.
+ * It is the only writer of sensor_frame and signals sensor_ready after each sample.
+ * The sampling period follows the speed setting (delay()).
  * 
  * @note This function is intended to be run in a separate thread.
  **/
 void update_json_loop() {
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Starting update json loop thread");
+    PipelineProbe::ThreadScope probe_scope(pipeline_probe, "update_json_loop");
+    LOG_STATIC(DEBUG, "Starting update json loop thread");
 
+    SensorFrame frame = sensor_frame.load();
     while (is_run) {
-        update_sensor_data(sensor_data);
+        update_sensor_data(frame);
+        sensor_frame.store(frame);
+        pipeline_probe.sampled(frame.sequence);
+        frames_sampled.inc();
+        sensor_ready.publish(frame.sequence);
         update_info(info);
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        delay();
     }
 
     std::cout << "Exiting update_json_loop thread" << std::endl;
-    logManager.setLogLevel(LogManager::INFO);
-    logManager.log(LogManager::INFO, "Exiting update json loop thread");
+    LOG_STATIC(INFO, "Exiting update json loop thread");
 }
 
 /**
  * @brief Sends the sensor data JSON to the WebSocket server.
  * 
  * This function sends the sensor data JSON to the WebSocket server.
- * It acquires a lock on the mutex to ensure thread safety.
+ * It wakes on publish_ready and sends the published frame with the prediction made for it, each
+ * sequence at most once; if it falls behind it skips to the latest frame.
+ * The message is built from a lock-free snapshot and sent without holding any lock.
  * 
  * @param c A pointer to the WebSocket client.
  * @param hdl The WebSocket connection handle.
@@ -288,36 +309,52 @@ void update_json_loop() {
  * @note This function is intended to be run in a separate thread.
  **/
 void send_json_loop(client* c, websocketpp::connection_hdl hdl) {
+    PipelineProbe::ThreadScope probe_scope(pipeline_probe, "send_json_loop");
     std::cout << "Starting send_json_loop thread" << std::endl;
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Starting send json loop thread");
+    LOG_STATIC(DEBUG, "Starting send json loop thread");
     
+    uint64_t last = 0;
     while (is_run) {
-        {
-            std::lock_guard<std::mutex> lock(mtx); // Ensuring thread safety
-            std::string message = sensor_data.dump(); // Serialize the JSON messages
-            // TODO if current mode is prediction mode then send data and prediction but if safe mode send only data not prediction
-            if (current_mode == SAFE_MODE) {
-                nlohmann::json safe_mode_data = sensor_data;
-                safe_mode_data.erase("Prediction");
-                c->send(hdl, safe_mode_data.dump(), websocketpp::frame::opcode::text);
-            } else {
-                c->send(hdl, message, websocketpp::frame::opcode::text);
-            }
+        uint64_t ready = publish_ready.wait_newer(last, stage_wait_timeout);
+        if (ready == last) {
+            continue;
+        }
+        // * the frame and its prediction come from one snapshot, at least as new as ready
+        PublishedFrame published = published_frame.load();
+        last = published.sensor.sequence;
+        const SensorFrame& frame = published.sensor;
+        // * prediction mode sends data and prediction, safe mode sends only data
+        const PredictionFrame& prediction = published.prediction;
+        std::shared_ptr<const SensorPayload> message = payload_cache.get(frame, (frame.mode == SAFE_MODE) ? nullptr : &prediction);
+        websocketpp::lib::error_code ec;
+        c->send(hdl, message->text, websocketpp::frame::opcode::text, ec);
+        if (ec) {
+            send_errors.inc();
+            std::cerr << "Send error: " << ec.message() << std::endl;
+        } else {
+            messages_sent.inc();
+            message_bytes_sent.inc(message->text.size());
+            pipeline_probe.sent(frame.sequence);
+        }
+        client::connection_ptr con = c->get_con_from_hdl(hdl, ec);
+        if (!ec) {
+            ws_buffered_bytes.set(con->get_buffered_amount());
         }
-        delay();
     }
 
     std::cout << "Exiting send_json_loop thread" << std::endl;
-    logManager.setLogLevel(LogManager::INFO);
-    logManager.log(LogManager::INFO, "Exiting send json loop thread");
+    LOG_STATIC(INFO, "Exiting send json loop thread");
+    // * last statement, the client is not touched after this
+    --send_threads_running;
 }
 
 /**
  * @brief Sends the sensor data JSON to the WebSocket server.
  *
  * This function sends the sensor data JSON to the WebSocket server.
- * It acquires a lock on the mutex to ensure thread safety.
+ * It wakes on publish_ready and sends the published frame with the prediction made for it, each
+ * sequence at most once; if it falls behind it skips to the latest frame.
+ * The message is built from a lock-free snapshot and sent without holding any lock.
  *
  * @param c A pointer to the TLS WebSocket client.
  * @param hdl The WebSocket connection handle.
@@ -325,150 +362,498 @@ void send_json_loop(client* c, websocketpp::connection_hdl hdl) {
  * @note This function is intended to be run in a separate thread.
  **/
 void send_json_loop_secure(tls_client* tc, websocketpp::connection_hdl hdl) {
+    PipelineProbe::ThreadScope probe_scope(pipeline_probe, "send_json_loop_secure");
     std::cout << "Starting send_json_loop_secure thread" << std::endl;
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Starting send json loop secure thread");
+    LOG_STATIC(DEBUG, "Starting send json loop secure thread");
 
-    while (is_run){
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            std::string message = sensor_data.dump();
-            websocketpp::lib::error_code ec;
-            // tc->send(hdl, message, websocketpp::frame::opcode::text, ec);
-            // TODO if current mode is prediction mode then send data and prediction but if safe mode send only data not prediction
-            if (current_mode == SAFE_MODE) {
-                nlohmann::json safe_mode_data = sensor_data;
-                safe_mode_data.erase("Prediction");
-                tc->send(hdl, safe_mode_data.dump(), websocketpp::frame::opcode::text, ec);
-            } else {
-                tc->send(hdl, message, websocketpp::frame::opcode::text, ec);
-            }
-            if (ec) {
-                std::cerr << "Send error: " << ec.message() << std::endl;
-            }
+    uint64_t last = 0;
+    while (is_run) {
+        uint64_t ready = publish_ready.wait_newer(last, stage_wait_timeout);
+        if (ready == last) {
+            continue;
+        }
+        // * the frame and its prediction come from one snapshot, at least as new as ready
+        PublishedFrame published = published_frame.load();
+        last = published.sensor.sequence;
+        const SensorFrame& frame = published.sensor;
+        // * prediction mode sends data and prediction, safe mode sends only data
+        const PredictionFrame& prediction = published.prediction;
+        std::shared_ptr<const SensorPayload> message = payload_cache.get(frame, (frame.mode == SAFE_MODE) ? nullptr : &prediction);
+        websocketpp::lib::error_code ec;
+        tc->send(hdl, message->text, websocketpp::frame::opcode::text, ec);
+        if (ec) {
+            send_errors.inc();
+            std::cerr << "Send error: " << ec.message() << std::endl;
+        } else {
+            messages_sent.inc();
+            message_bytes_sent.inc(message->text.size());
+            pipeline_probe.sent(frame.sequence);
+        }
+        tls_client::connection_ptr con = tc->get_con_from_hdl(hdl, ec);
+        if (!ec) {
+            ws_buffered_bytes.set(con->get_buffered_amount());
         }
-        delay();
     }
 
     std::cout << "Exiting send_json_loop_secure thread" << std::endl;
-    logManager.setLogLevel(LogManager::INFO);
-    logManager.log(LogManager::INFO, "Exiting send json loop secure thread");
+    LOG_STATIC(INFO, "Exiting send json loop secure thread");
+    // * last statement, the client is not touched after this
+    --send_threads_running;
+}
+
+// * Model files, model.bin (mapped, no parsing) is preferred over model.json
+const std::string model_bin_path = "EdgeFrontier/model/model.bin";
+const std::string model_json_path = "EdgeFrontier/model/model.json";
+
+/**
+ * @brief Per-thread buffers for AiModel::predict, the model itself is never written.
+ **/
+struct AiScratch {
+    DenseNetwork<double>::Scratch dense;
+    QuantizedNetwork::Scratch int8;
+    HalfNetwork::Scratch half;
+};
+
+/**
+ * @brief A loaded AI model: the double network, its int8 quantization or its fp16/bf16 copy.
+ *
+ * Read-only once published, predict keeps every intermediate value in the caller's AiScratch
+ * so any number of threads can share one model.
+ **/
+struct AiModel {
+    std::shared_ptr<DenseNetwork<double>> dense;
+    std::shared_ptr<QuantizedNetwork> int8;
+    std::shared_ptr<HalfNetwork> half;
+
+    int outputSize() const {
+        if (int8 != nullptr) {
+            return int8->outputSize();
+        }
+        return half != nullptr ? half->outputSize() : dense->outputSize();
+    }
+
+    void predict(const double* inputs, double* outputs, AiScratch& scratch) const {
+        if (int8 != nullptr) {
+            int8->predict(inputs, outputs, scratch.int8);
+        } else if (half != nullptr) {
+            half->predict(inputs, outputs, scratch.half);
+        } else {
+            dense->predict(inputs, outputs, scratch.dense);
+        }
+    }
+};
+
+// * Currently active AI model, replaced atomically (std::atomic_load / std::atomic_store) on reload
+std::shared_ptr<AiModel> ai_model;
+// * Set by handle_machine when the server announces a new model version
+std::atomic<bool> model_reload_requested(false);
+
+/**
+ * @brief Returns the modification time of a file, or 0 if it does not exist.
+ **/
+std::time_t file_mtime(const std::string& path) {
+    struct stat info;
+    return (stat(path.c_str(), &info) == 0) ? info.st_mtime : 0;
+}
+
+/**
+ * @brief Inputs used to check a reduced precision model against the original.
+ *
+ * 1000 fixed-seed samples uniform over 0..100, the range of the sensor readings fed to the model.
+ **/
+std::vector<std::vector<double>> calibration_samples(int inputs) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dis(0.0, 100.0);
+    std::vector<std::vector<double>> calibration(1000, std::vector<double>(inputs));
+    for (std::vector<double>& sample : calibration) {
+        for (double& value : sample) {
+            value = dis(gen);
+        }
+    }
+    return calibration;
+}
+
+void log_model_accuracy(const std::string& engine, size_t bytes, const char* backend, const QuantizationReport& report) {
+    LOG_MSG(INFO, "AI model converted to " + engine + " (" + std::to_string(bytes) + " bytes, " + backend +
+                  "), max abs error " + std::to_string(report.maxAbsError) +
+                  ", mean abs error " + std::to_string(report.meanAbsError) +
+                  ", top-1 agreement " + std::to_string(report.top1Agreement));
+}
+
+/**
+ * @brief Quantizes a loaded network to int8 and logs its accuracy against the original.
+ **/
+std::shared_ptr<QuantizedNetwork> quantize_model(DenseNetwork<double>& model) {
+    std::shared_ptr<QuantizedNetwork> quantized = std::make_shared<QuantizedNetwork>();
+    quantized->quantize(model);
+    QuantizationReport report = quantized->evaluate(model, calibration_samples(model.inputSize()));
+    log_model_accuracy("int8", quantized->weightBytes(), KernelsInt8::backend(), report);
+    return quantized;
+}
+
+/**
+ * @brief Converts a loaded network to fp16 or bf16 weights and logs its accuracy against the original.
+ **/
+std::shared_ptr<HalfNetwork> half_model(DenseNetwork<double>& model, HalfFormat format) {
+    std::shared_ptr<HalfNetwork> half = std::make_shared<HalfNetwork>();
+    half->convert(model, format);
+    QuantizationReport report = half->evaluate(model, calibration_samples(model.inputSize()));
+    log_model_accuracy(format == HALF_FP16 ? "fp16" : "bf16", half->weightBytes(), KernelsHalf::backend(), report);
+    return half;
+}
+
+/**
+ * @brief Loads the AI model from disk into a new, fully built network.
+ *
+ * MODEL_ENGINE=int8 quantizes the network after loading and serves the int8 copy,
+ * MODEL_ENGINE=fp16 or bf16 serves a copy with 16-bit weights.
+ * MODEL_ACTIVATION=exact, rational or table overrides the sigmoid/tanh precision of the model file.
+ * model.bin is only used while it is at least as recent as model.json, an updated model.json
+ * is loaded instead of a stale model.bin (regenerate it with make model).
+ *
+ * @return The loaded model, or nullptr if it could not be loaded or does not fit the sensor inputs.
+ **/
+std::shared_ptr<AiModel> load_model() {
+    std::shared_ptr<DenseNetwork<double>> model = std::make_shared<DenseNetwork<double>>();
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    std::time_t bin_mtime = file_mtime(model_bin_path);
+    std::time_t json_mtime = file_mtime(model_json_path);
+    // * same second counts as up to date, make model writes model.bin right after model.json
+    bool use_bin = bin_mtime != 0 && bin_mtime >= json_mtime;
+    if (bin_mtime != 0 && !use_bin) {
+        LOG_MSG(WARNING, "AI model " + model_bin_path + " is older than " + model_json_path + ", loading " + model_json_path);
+    }
+    const std::string& path = use_bin ? model_bin_path : model_json_path;
+    try {
+        if (use_bin) {
+            model->import_from_binary(path);
+        } else {
+            model->import_from_json(path);
+        }
+    } catch (const std::exception& e) {
+        model_load_failures.inc();
+        LOG_MSG(ERR, "Unable to load AI model: " + std::string(e.what()));
+        return nullptr;
+    }
+    if (model->inputSize() != 6) {
+        model_load_failures.inc();
+        LOG_MSG(ERR, "AI model expects " + std::to_string(model->inputSize()) + " inputs, sensor provides 6");
+        return nullptr;
+    }
+    if (getenv("MODEL_ACTIVATION") != nullptr) {
+        ActivationPrecision precision;
+        if (parseActivationPrecision(getenv("MODEL_ACTIVATION"), precision)) {
+            model->setActivationPrecision(precision);
+        } else {
+            LOG_MSG(WARNING, "Unknown MODEL_ACTIVATION " + std::string(getenv("MODEL_ACTIVATION")) + ", keeping the model precision");
+        }
+    }
+
+    std::shared_ptr<AiModel> loaded = std::make_shared<AiModel>();
+    std::string engine = getenv("MODEL_ENGINE") != nullptr ? getenv("MODEL_ENGINE") : "";
+    if (engine == "int8") {
+        loaded->int8 = quantize_model(*model);
+    } else if (engine == "fp16" || engine == "bf16") {
+        loaded->half = half_model(*model, engine == "fp16" ? HALF_FP16 : HALF_BF16);
+    } else {
+        loaded->dense = model;
+    }
+    model_load_duration.record(std::chrono::steady_clock::now() - started);
+    LOG_MSG(INFO, "AI model loaded from " + path);
+    return loaded;
+}
+
+/**
+ * @brief Watches the model files and swaps in a new model when they change.
+ *
+ * The new model is loaded completely on this thread, then published with one atomic
+ * shared_ptr store, so Ai_handle never waits for a load nor sees a half-loaded model.
+ * A reload can also be requested by the server through handle_machine (ModelVersion).
+ * Replace model files atomically (write then rename), model.bin is mapped while in use.
+ *
+ * @note This function is intended to be run in a separate thread.
+ **/
+void model_watch_loop() {
+    PipelineProbe::ThreadScope probe_scope(pipeline_probe, "model_watch_loop");
+    LOG_STATIC(DEBUG, "Starting model watch thread");
+
+    std::time_t bin_mtime = file_mtime(model_bin_path);
+    std::time_t json_mtime = file_mtime(model_json_path);
+    while (is_run) {
+        delay_server();
+
+        std::time_t new_bin_mtime = file_mtime(model_bin_path);
+        std::time_t new_json_mtime = file_mtime(model_json_path);
+        bool changed = new_bin_mtime != bin_mtime || new_json_mtime != json_mtime;
+        if (!changed && !model_reload_requested.exchange(false)) {
+            continue;
+        }
+        bin_mtime = new_bin_mtime;
+        json_mtime = new_json_mtime;
+
+        std::shared_ptr<AiModel> model = load_model();
+        if (model == nullptr) {
+            LOG_STATIC(WARNING, "AI model reload failed, keeping current model");
+            continue;
+        }
+        std::atomic_store(&ai_model, model);
+        model_reloads.inc();
+        LOG_STATIC(INFO, "AI model reloaded");
+    }
+
+    LOG_STATIC(INFO, "Exiting model watch thread");
 }
 
 void Ai_handle() {
-    MultiLayerPerceptron<double> mlp;
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Setting up AI model");
+    PipelineProbe::ThreadScope probe_scope(pipeline_probe, "Ai_handle");
+    // * Fused dense layers: one contiguous weight matrix per layer instead of one Perceptron per neuron
+    LOG_STATIC(DEBUG, "Setting up AI model");
+
+    // * without a model frames are still forwarded to the publishers, the watch thread may load one later
+    std::atomic_store(&ai_model, load_model());
+    std::thread watch_thread(model_watch_loop);
+    LOG_STATIC(DEBUG, "Starting Ai_handle thread");
 
-    mlp.import_from_json("EdgeFrontier/model/model.json");
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Starting Ai_handle thread");
+    double inputs[6];
+    std::vector<double> outputs;
+    AiScratch scratch;
+    PublishedFrame published = published_frame.load();
 
+    uint64_t last = 0;
     while (is_run){
-        {
-            if (current_mode == PREDICTION_MODE) {
-                vector<vector<double>> inputs = {{
-                        sensor_data["Data"]["CO2"].get<double>(),
-                        sensor_data["Data"]["VOC"].get<double>(),
-                        sensor_data["Data"]["RA"].get<double>(),
-                        sensor_data["Data"]["TEMP"].get<double>(),
-                        sensor_data["Data"]["HUMID"].get<double>(),
-                        sensor_data["Data"]["PRESSURE"].get<double>()
-                    }};
-                vector<vector<double>> prediction = mlp.predict(inputs, NONE);
-                std::lock_guard<std::mutex> lock(mtx);
-                for (int i = 0; i < prediction[0].size(); ++i) {
-                    sensor_data["Prediction"][Event[i]] = prediction[0][i] * 100;
-                }
+        uint64_t ready = sensor_ready.wait_newer(last, stage_wait_timeout);
+        if (ready == last) {
+            continue;
+        }
+        last = ready;
+
+        SensorFrame frame = sensor_frame.load();
+        // * hold a reference for this prediction, a concurrent reload cannot free it
+        std::shared_ptr<const AiModel> mlp = std::atomic_load(&ai_model);
+        if (frame.mode == PREDICTION_MODE && mlp != nullptr) {
+            outputs.resize(mlp->outputSize());
+            inputs[0] = frame.co2;
+            inputs[1] = frame.voc;
+            inputs[2] = frame.ra;
+            inputs[3] = frame.temp;
+            inputs[4] = frame.humid;
+            inputs[5] = frame.pressure;
+            std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+            mlp->predict(inputs, outputs.data(), scratch);
+            prediction_duration.record(std::chrono::steady_clock::now() - started);
+
+            published.prediction.sequence = frame.sequence;
+            for (size_t i = 0; i < SENSOR_EVENT_COUNT; ++i) {
+                published.prediction.values[i] = (i < outputs.size()) ? outputs[i] * 100 : 0.0;
             }
         }
-        delay();
+        // * the frame is published with the prediction made for it, before the senders are woken
+        published.sensor = frame;
+        published_frame.store(published);
+        publish_ready.publish(frame.sequence);
     }
 
-    mlp.clearModel();
+    if (watch_thread.joinable()) {
+        watch_thread.join();
+    }
+    std::atomic_store(&ai_model, std::shared_ptr<AiModel>());
 
     std::cout << "Exiting Ai_handle thread" << std::endl;
-    logManager.setLogLevel(LogManager::INFO);
-    logManager.log(LogManager::INFO, "Exiting AI handle thread");
+    LOG_STATIC(INFO, "Exiting AI handle thread");
 }
 
+// * Last ModelVersion reported by the server, only touched by apply_machine_info
+nlohmann::json model_version;
+// * Serializes control updates coming from the WebSocket and the HTTP fallback
+std::mutex machine_info_mtx;
+// * true while the WebSocket is open, control commands are then pushed by the server
+std::atomic<bool> control_channel_up(false);
+
+/**
+ * @brief Applies the mode, speed and model version the server sent for this hardware.
+ *
+ * Used for both the /hardware response and control frames pushed over the WebSocket;
+ * Mode, Speed and ModelVersion are each optional, only the ones present are applied.
+ *
+ * @param pre_info The parsed JSON body.
+ **/
+void apply_machine_info(const nlohmann::json& pre_info) {
+    std::string MODE, SPEED;
+    std::lock_guard<std::mutex> lock(machine_info_mtx);
+    if (pre_info["HardwareID"] == HardwareID) {
+        MODE = pre_info.value("Mode", "");
+        SPEED = pre_info.value("Speed", "");
+        std::transform(MODE.begin(), MODE.end(), MODE.begin(), ::toupper);
+        std::transform(SPEED.begin(), SPEED.end(), SPEED.begin(), ::toupper);
+        if (MODE == "") {
+            // * mode not part of this update
+        } else if (MODE == "PREDICTION") {
+            // * check if current mode is not prediction mode then switch to prediction mode
+            if (current_mode != PREDICTION_MODE) {
+                current_mode = PREDICTION_MODE;
+                LOG_STATIC(INFO, "Switching to PREDICTION mode");
+            }
+        } else {
+            // * check if current mode is not safe mode then switch to safe mode
+            if (current_mode != SAFE_MODE) {
+                current_mode = SAFE_MODE;
+                LOG_STATIC(INFO, "Switching to SAFE mode");
+            }
+        }
+        if (SPEED == "") {
+            // * speed not part of this update
+        } else if (SPEED == "SLOW") {
+            if (current_speed != SLOW) {
+                current_speed = SLOW;
+                LOG_STATIC(INFO, "Setting speed to SLOW");
+            }
+        } else if (SPEED == "MEDIUM") {
+            if (current_speed != MEDIUM) {
+                current_speed = MEDIUM;
+                LOG_STATIC(INFO, "Setting speed to MEDIUM");
+            }
+        } else {
+            if (current_speed != FAST) {
+                current_speed = FAST;
+                LOG_STATIC(INFO, "Setting speed to FAST");
+            }
+        }
+        // * a new ModelVersion from the server triggers a background model reload
+        if (pre_info.contains("ModelVersion")) {
+            if (!model_version.is_null() && pre_info["ModelVersion"] != model_version) {
+                model_reload_requested = true;
+                LOG_STATIC(INFO, "Model version changed, requesting reload");
+            }
+            model_version = pre_info["ModelVersion"];
+        }
+    } else {
+        std::cerr << "HardwareID not match" << std::endl;
+        LOG_STATIC(ERR, "HardwareID not match");
+    }
+}
+
+void apply_machine_info(const std::string& res) {
+    apply_machine_info(nlohmann::json::parse(res));
+}
+
+/**
+ * @brief Fallback control polling for when the WebSocket control channel is down.
+ *
+ * While the WebSocket is open the server pushes mode/speed changes (on_message) and this
+ * thread sends nothing. When it is down, /hardware is polled asynchronously with a timeout
+ * and handled by apply_machine_info; the interval starts at 1 s and doubles after every
+ * poll up to 32 s, so a fleet that lost its sockets does not hammer the server. It returns
+ * to 1 s as soon as the channel is up again. A new poll is only sent once the previous
+ * one has finished.
+ *
+ * @note This function is intended to be run in a separate thread.
+ **/
 void handle_machine(){
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Starting handle_machine thread");
+    PipelineProbe::ThreadScope probe_scope(pipeline_probe, "handle_machine");
+    LOG_STATIC(DEBUG, "Starting handle_machine thread");
     nlohmann::json HID_only;
-    nlohmann::json pre_info;
+    std::shared_ptr<std::atomic<bool>> poll_in_flight = std::make_shared<std::atomic<bool>>(false);
 
-    std::string HID, MODE, SPEED;
+    const int max_backoff = 32;
+    int backoff = 1;   // * seconds until the next fallback poll
+    int waited = backoff;  // * poll right away on start
     while (is_run) {
-        HID_only = {
-            {"HardwareID", HardwareID}
-        };
-        std::cout << HID_only.dump(4) << std::endl;
-        std::string res = http.post_json(rest_main_server_cstr + "/hardware", HID_only.dump());
-        std::cout << "Response: " << res << std::endl;
-        if (res != "") {
-            pre_info = nlohmann::json::parse(res);
-            if (pre_info["HardwareID"] == HardwareID) {
-                MODE = pre_info["Mode"].get<std::string>();
-                SPEED = pre_info["Speed"].get<std::string>();
-                std::transform(HardwareID.begin(), HardwareID.end(), HardwareID.begin(), ::toupper);
-                std::transform(MODE.begin(), MODE.end(), MODE.begin(), ::toupper);
-                std::transform(SPEED.begin(), SPEED.end(), SPEED.begin(), ::toupper);
-                if (MODE == "PREDICTION") {
-                    // * check if current mode is not prediction mode then switch to prediction mode
-                    if (current_mode != PREDICTION_MODE) {
-                        current_mode = PREDICTION_MODE;
-                        logManager.setLogLevel(LogManager::INFO);
-                        logManager.log(LogManager::INFO, "Switching to PREDICTION mode");
-                    }
-                } else {
-                    // * check if current mode is not safe mode then switch to safe mode
-                    if (current_mode != SAFE_MODE) {
-                        current_mode = SAFE_MODE;
-                        logManager.setLogLevel(LogManager::INFO);
-                        logManager.log(LogManager::INFO, "Switching to SAFE mode");
-                    }
+        if (control_channel_up) {
+            backoff = 1;
+            waited = 0;
+        } else if (waited >= backoff && !poll_in_flight->exchange(true)) {
+            HID_only = {
+                {"HardwareID", HardwareID}
+            };
+            LOG_MSG(DEBUG, "Hardware poll: " + HID_only.dump());
+            std::chrono::steady_clock::time_point poll_started = std::chrono::steady_clock::now();
+            http.post_json_async(rest_main_server_cstr + "/hardware", HID_only.dump(), [poll_in_flight, poll_started](const HTTPResponse& response) {
+                // * callbacks run one at a time on the event loop, clearing first keeps polling alive if parsing throws
+                *poll_in_flight = false;
+                hardware_poll_duration.record(std::chrono::steady_clock::now() - poll_started);
+                if (!response.ok()) {
+                    hardware_poll_failures.inc();
                 }
-                if (SPEED == "SLOW") {
-                    if (current_speed != SLOW) {
-                        current_speed = SLOW;
-                        logManager.setLogLevel(LogManager::INFO);
-                        logManager.log(LogManager::INFO, "Setting speed to SLOW");
-                    }
-                } else if (SPEED == "MEDIUM") {
-                    if (current_speed != MEDIUM) {
-                        current_speed = MEDIUM;
-                        logManager.setLogLevel(LogManager::INFO);
-                        logManager.log(LogManager::INFO, "Setting speed to MEDIUM");
-                    }
-                } else {
-                    if (current_speed != FAST) {
-                        current_speed = FAST;
-                        logManager.setLogLevel(LogManager::INFO);
-                        logManager.log(LogManager::INFO, "Setting speed to FAST");
-                    }
+                LOG_MSG(DEBUG, "Hardware poll response: " + response.body);
+                if (response.ok() && response.body != "") {
+                    apply_machine_info(response.body);
+                } else if (response.code != CURLE_OK) {
+                    LOG_MSG(WARNING, "Hardware poll failed: " + std::string(curl_easy_strerror(response.code)));
                 }
-            } else {
-                std::cerr << "HardwareID not match" << std::endl;
-                logManager.setLogLevel(LogManager::ERR);
-                logManager.log(LogManager::ERR, "HardwareID not match");
-            }
+            }, http_timeout_ms);
+            backoff = std::min(backoff * 2, max_backoff);
+            waited = 0;
         }
         delay_server();
+        ++waited;
     }
-    logManager.setLogLevel(LogManager::INFO);
-    logManager.log(LogManager::INFO, "Exiting handle_machine thread");
+    LOG_STATIC(INFO, "Exiting handle_machine thread");
+}
+
+/**
+ * @brief Handles a control frame pushed by the server over the WebSocket.
+ *
+ * Wire format: a JSON text frame with the fields of the /hardware response plus the
+ * "Type": "control" discriminator, and no "Data" or "Event" key:
+ *
+ *   {"Type": "control", "HardwareID": "<id>", "Mode": "PREDICTION" | "SAFE",
+ *    "Speed": "SLOW" | "MEDIUM" | "FAST", "ModelVersion": <any>}
+ *
+ * Type and HardwareID are required, the other fields are optional. Anything else is
+ * ignored silently: sensor frames (ours echoed back or another device's) also carry
+ * HardwareID and Mode and must not change the mode, and control frames addressed to
+ * another HardwareID are not for this device.
+ *
+ * @param payload The text frame payload.
+ **/
+void handle_control_message(const std::string& payload) {
+    try {
+        nlohmann::json j = nlohmann::json::parse(payload);
+        if (!j.is_object() || j.value("Type", "") != "control" || j.contains("Data") || j.contains("Event")) {
+            return;
+        }
+        if (!j.contains("HardwareID") || j["HardwareID"] != HardwareID) {
+            return;
+        }
+        control_messages.inc();
+        apply_machine_info(j);
+    } catch (const std::exception& e) {
+        LOG_MSG(WARNING, "Invalid control message: " + std::string(e.what()));
+    }
+}
+
+void on_message(websocketpp::connection_hdl, client::message_ptr msg) {
+    if (msg->get_opcode() == websocketpp::frame::opcode::text) {
+        handle_control_message(msg->get_payload());
+    }
+}
+
+void on_message_secure(websocketpp::connection_hdl, tls_client::message_ptr msg) {
+    if (msg->get_opcode() == websocketpp::frame::opcode::text) {
+        handle_control_message(msg->get_payload());
+    }
+}
+
+/**
+ * @brief Handles the close and fail events, control falls back to HTTP polling.
+ **/
+void on_control_channel_down(websocketpp::connection_hdl) {
+    control_channel_up = false;
+    LOG_STATIC(WARNING, "WebSocket control channel down, falling back to HTTP polling");
 }
 
 /**
  * @brief Handles the on_open event for a non-secure WebSocket connection.
  * 
  * This function starts a separate thread for sending the sensor data JSON to the WebSocket server.
+ * From now on the server pushes control commands over this connection.
  * 
  * @param c A pointer to the WebSocket client.
  * @param hdl The WebSocket connection handle.
  **/
 void on_open(client* c, websocketpp::connection_hdl hdl) {
+    control_channel_up = true;
+    ++send_threads_running;
     std::thread send_thread(send_json_loop, c, hdl);
     send_thread.detach();
 }
@@ -477,11 +862,14 @@ void on_open(client* c, websocketpp::connection_hdl hdl) {
  * @brief Handles the on_open event for a secure WebSocket connection.
  *
  * This function starts a separate thread for sending the sensor data JSON to the WebSocket server.
+ * From now on the server pushes control commands over this connection.
  *
  * @param c A pointer to the TLS WebSocket client.
  * @param hdl The WebSocket connection handle.
  **/
 void on_open_secure(tls_client* tc, websocketpp::connection_hdl hdl) {
+    control_channel_up = true;
+    ++send_threads_running;
     std::thread send_thread(send_json_loop_secure, tc, hdl);
     send_thread.detach();
 }
@@ -506,8 +894,7 @@ std::shared_ptr<boost::asio::ssl::context> on_tls_init(websocketpp::connection_h
                          boost::asio::ssl::context::single_dh_use);
     } catch (std::exception& e) {
         std::cerr << "TLS error: " << e.what() << std::endl;
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "TLS error: " + std::string(e.what()));
+        LOG_MSG(ERR, "TLS error: " + std::string(e.what()));
         throw;
     }
     return ctx;
@@ -535,11 +922,9 @@ void handle_no_secure(const std::string &uri, client *c)
         if (uri_clean.find_first_of("\t\n\r\f\v") != std::string::npos)
         {
             uri_clean.erase(uri_clean.find_first_of("\t\n\r\f\v"));
-            logManager.setLogLevel(LogManager::DEBUG);
-            logManager.log(LogManager::DEBUG, "Deleted \\t\\n\\r\\f\\v from uri and now uri is clean");
+            LOG_STATIC(DEBUG, "Deleted \\t\\n\\r\\f\\v from uri and now uri is clean");
         }
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "Setting up non-secure WebSocket connection");
+        LOG_STATIC(DEBUG, "Setting up non-secure WebSocket connection");
         // * Set logging settings for WebSocket client
         c->set_error_channels(websocketpp::log::elevel::none);
         c->set_access_channels(websocketpp::log::alevel::none);
@@ -547,30 +932,31 @@ void handle_no_secure(const std::string &uri, client *c)
         c->init_asio();
         // * Set the open handler for the WebSocket connection
         c->set_open_handler(websocketpp::lib::bind(&on_open, c, websocketpp::lib::placeholders::_1));
+        // * Control commands are pushed by the server, HTTP polling only runs while the connection is down
+        c->set_message_handler(websocketpp::lib::bind(&on_message, websocketpp::lib::placeholders::_1, websocketpp::lib::placeholders::_2));
+        c->set_close_handler(websocketpp::lib::bind(&on_control_channel_down, websocketpp::lib::placeholders::_1));
+        c->set_fail_handler(websocketpp::lib::bind(&on_control_channel_down, websocketpp::lib::placeholders::_1));
         // * Create connection to WebSocket server
         websocketpp::lib::error_code ec;
         client::connection_ptr con = c->get_connection(uri_clean, ec);
         if (ec)
         {
             std::cerr << "Error: " << ec.message() << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "Error: " + ec.message());
+            LOG_MSG(ERR, "Error: " + ec.message());
             return;
         }
         // * Connect to the server
         c->connect(con);
-        logManager.setLogLevel(LogManager::INFO);
-        logManager.log(LogManager::INFO, "Connected to WebSocket server");
+        LOG_STATIC(INFO, "Connected to WebSocket server");
         // * Start a separate thread for WebSocket client to handle the connection
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "Starting WebSocket client thread");
+        LOG_STATIC(DEBUG, "Starting WebSocket client thread");
         std::thread websocket_thread([c]()
                                      {
+                                         PipelineProbe::ThreadScope probe_scope(pipeline_probe, "websocket_thread");
                                          c->run(); // * Run the WebSocket client
                                      });
         // * Start threads for updating and printing the sensor data
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "Starting data is_run with threads");
+        LOG_STATIC(DEBUG, "Starting data is_run with threads");
         std::thread update_thread(update_json_loop);
         std::thread print_thread(print_json);
         std::thread Ai_thread(Ai_handle);
@@ -578,58 +964,48 @@ void handle_no_secure(const std::string &uri, client *c)
         if (update_thread.joinable()) {
             update_thread.join();
             std::cout << "update_thread joined" << std::endl;
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "Updating sensor data thread joined");
+            LOG_STATIC(INFO, "Updating sensor data thread joined");
         } else {
             std::cerr << "update_thread is not joinable" << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "Updating sensor data thread is not joinable");
+            LOG_STATIC(ERR, "Updating sensor data thread is not joinable");
         }
 
         if (print_thread.joinable()) {
             print_thread.join();
             std::cout << "print_thread joined" << std::endl;
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "Printing sensor data thread joined");
+            LOG_STATIC(INFO, "Printing sensor data thread joined");
         } else {
             std::cerr << "print_thread is not joinable" << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "Printing sensor data thread is not joinable");
+            LOG_STATIC(ERR, "Printing sensor data thread is not joinable");
         }
 
         if (Ai_thread.joinable()) {
             Ai_thread.join();
             std::cout << "Ai_thread joined" << std::endl;
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "AI thread joined");
+            LOG_STATIC(INFO, "AI thread joined");
         } else {
             std::cerr << "Ai_thread is not joinable" << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "AI thread is not joinable");
+            LOG_STATIC(ERR, "AI thread is not joinable");
         }
 
         if (!is_run) {
             c->close(con->get_handle(), websocketpp::close::status::normal, "User requested disconnect");
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "Disconnected from WebSocket server");
+            LOG_STATIC(INFO, "Disconnected from WebSocket server");
         }
 
         websocket_thread.join();
         std::cout << "websocket_thread joined" << std::endl;
-        logManager.setLogLevel(LogManager::INFO);
-        logManager.log(LogManager::INFO, "WebSocket client thread joined");
+        LOG_STATIC(INFO, "WebSocket client thread joined");
     }
     catch (const websocketpp::exception &e)
     {
         std::cerr << "WebSocket error: " << e.what() << std::endl;
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "WebSocket error: " + std::string(e.what()));
+        LOG_MSG(ERR, "WebSocket error: " + std::string(e.what()));
     }
     catch (const std::exception &e)
     {
         std::cerr << "Error: " << e.what() << std::endl;
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "Error: " + std::string(e.what()));
+        LOG_MSG(ERR, "Error: " + std::string(e.what()));
     }
 }
 
@@ -662,12 +1038,10 @@ void handle_secure(const std::string &uri, tls_client *tc)
         if (uri_clean.find_first_of("\t\n\r\f\v") != std::string::npos)
         {
             uri_clean.erase(uri_clean.find_first_of("\t\n\r\f\v"));
-            logManager.setLogLevel(LogManager::DEBUG);
-            logManager.log(LogManager::DEBUG, "Deleted \\t\\n\\r\\f\\v from uri and now uri is clean");
+            LOG_STATIC(DEBUG, "Deleted \\t\\n\\r\\f\\v from uri and now uri is clean");
         }
 
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "Setting up secure WebSocket connection");
+        LOG_STATIC(DEBUG, "Setting up secure WebSocket connection");
         // * Set logging settings for WebSocket client
         tc->set_error_channels(websocketpp::log::elevel::none);
         tc->set_access_channels(websocketpp::log::alevel::none);
@@ -677,6 +1051,10 @@ void handle_secure(const std::string &uri, tls_client *tc)
         tc->set_tls_init_handler(websocketpp::lib::bind(&on_tls_init, websocketpp::lib::placeholders::_1));
         // * Set the open handler for the WebSocket connection
         tc->set_open_handler(websocketpp::lib::bind(&on_open_secure, tc, websocketpp::lib::placeholders::_1));
+        // * Control commands are pushed by the server, HTTP polling only runs while the connection is down
+        tc->set_message_handler(websocketpp::lib::bind(&on_message_secure, websocketpp::lib::placeholders::_1, websocketpp::lib::placeholders::_2));
+        tc->set_close_handler(websocketpp::lib::bind(&on_control_channel_down, websocketpp::lib::placeholders::_1));
+        tc->set_fail_handler(websocketpp::lib::bind(&on_control_channel_down, websocketpp::lib::placeholders::_1));
         
         // * Create connection to WebSocket server
         websocketpp::lib::error_code ec;
@@ -685,24 +1063,21 @@ void handle_secure(const std::string &uri, tls_client *tc)
         if (ec)
         {
             std::cerr << "Error: " << ec.message() << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "Error: " + ec.message());
+            LOG_MSG(ERR, "Error: " + ec.message());
             return;
         }
         // * Connect to the server
         tc->connect(con);
         std::thread websocket_thread([tc]()
                                         {
+                                            PipelineProbe::ThreadScope probe_scope(pipeline_probe, "websocket_thread");
                                             tc->run(); // * Run the WebSocket client
                                         });
-        logManager.setLogLevel(LogManager::INFO);
-        logManager.log(LogManager::INFO, "Connected to secure WebSocket server");
+        LOG_STATIC(INFO, "Connected to secure WebSocket server");
         // * Start a separate thread for WebSocket client to handle the connection
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "Starting WebSocket client thread");
+        LOG_STATIC(DEBUG, "Starting WebSocket client thread");
         // * Start threads for updating and printing the sensor data
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "Starting data is_run with threads");
+        LOG_STATIC(DEBUG, "Starting data is_run with threads");
         std::thread update_thread(update_json_loop);
         std::thread print_thread(print_json);
         std::thread Ai_thread(Ai_handle);
@@ -710,65 +1085,53 @@ void handle_secure(const std::string &uri, tls_client *tc)
         if (update_thread.joinable()) {
             update_thread.join();
             std::cout << "update_thread joined" << std::endl;
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "Updating sensor data thread joined");
+            LOG_STATIC(INFO, "Updating sensor data thread joined");
         } else {
             std::cerr << "update_thread is not joinable" << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "Updating sensor data thread is not joinable");
+            LOG_STATIC(ERR, "Updating sensor data thread is not joinable");
         } 
 
         if (print_thread.joinable()) {
             print_thread.join();
             std::cout << "print_thread joined" << std::endl;
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "Printing sensor data thread joined");
+            LOG_STATIC(INFO, "Printing sensor data thread joined");
         } else {
             std::cerr << "print_thread is not joinable" << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "Printing sensor data thread is not joinable");
+            LOG_STATIC(ERR, "Printing sensor data thread is not joinable");
         }
 
         if (Ai_thread.joinable()) {
             Ai_thread.join();
             std::cout << "Ai_thread joined" << std::endl;
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "AI thread joined");
+            LOG_STATIC(INFO, "AI thread joined");
         } else {
             std::cerr << "Ai_thread is not joinable" << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "AI thread is not joinable");
+            LOG_STATIC(ERR, "AI thread is not joinable");
         }
 
         if (!is_run) {
             tc->close(con->get_handle(), websocketpp::close::status::normal, "User requested disconnect");
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "Disconnected from secure WebSocket server");
+            LOG_STATIC(INFO, "Disconnected from secure WebSocket server");
         }
 
         if (websocket_thread.joinable()) {
             websocket_thread.join();
             std::cout << "websocket_thread joined" << std::endl;
-            logManager.setLogLevel(LogManager::INFO);
-            logManager.log(LogManager::INFO, "WebSocket client thread joined");
+            LOG_STATIC(INFO, "WebSocket client thread joined");
         } else {
             std::cerr << "websocket_thread is not joinable" << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "WebSocket client thread is not joinable");
+            LOG_STATIC(ERR, "WebSocket client thread is not joinable");
         }
 
         std::cout << "websocket_thread joined" << std::endl;
-        logManager.setLogLevel(LogManager::INFO);
-        logManager.log(LogManager::INFO, "WebSocket client thread joined");
+        LOG_STATIC(INFO, "WebSocket client thread joined");
 
     } catch (const websocketpp::exception &e) {
         std::cerr << "WebSocket error: " << e.what() << std::endl;
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "WebSocket error: " + std::string(e.what()));
+        LOG_MSG(ERR, "WebSocket error: " + std::string(e.what()));
     } catch (const std::exception &e) {
         std::cerr << "Error: " << e.what() << std::endl;
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "Error: " + std::string(e.what()));
+        LOG_MSG(ERR, "Error: " + std::string(e.what()));
     }
 }
 
@@ -791,8 +1154,7 @@ std::unordered_map<std::string, std::string> loadEnvFile(const std::string& file
     std::ifstream envFile(filePath);
     if (!envFile.is_open()) {
         std::cerr << "Error: Unable to open .env file: " << filePath << std::endl;
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "Unable to open .env file: " + filePath);
+        LOG_MSG(ERR, "Unable to open .env file: " + filePath);
         return envMap;
     }
 
@@ -800,24 +1162,21 @@ std::unordered_map<std::string, std::string> loadEnvFile(const std::string& file
     while (std::getline(envFile, line)) {
         // Skip comments or empty lines
         if (line.empty() || line[0] == '#') {
-            logManager.setLogLevel(LogManager::DEBUG);
-            logManager.log(LogManager::DEBUG, "Skipping comment or empty line in .env file");
+            LOG_STATIC(DEBUG, "Skipping comment or empty line in .env file");
             continue;
         }
 
         size_t delimiterPos = line.find('=');
         if (delimiterPos == std::string::npos) {
             std::cerr << "Error: Malformed line in .env file: " << line << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "Malformed line in .env file: " + line);
+            LOG_MSG(ERR, "Malformed line in .env file: " + line);
             continue;
         }
 
         std::string key = line.substr(0, delimiterPos);
         std::string value = line.substr(delimiterPos + 1);
 
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "Loaded .env KEY : " + key);
+        LOG_MSG(DEBUG, "Loaded .env KEY : " + key);
 
         // Trim whitespace (optional, implement trim logic if needed)
         envMap[key] = value;
@@ -848,17 +1207,253 @@ bool is_secure(const std::string &uri)
     bool is_secure = uri.substr(0, 3) == "wss";
     if (is_secure)
     {
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "WebSocket connection is secure");
+        LOG_STATIC(DEBUG, "WebSocket connection is secure");
     }
     else
     {
-        logManager.setLogLevel(LogManager::WARNING);
-        logManager.log(LogManager::WARNING, "WebSocket connection is not secure");
+        LOG_STATIC(WARNING, "WebSocket connection is not secure");
     }
     return is_secure;
 }
 
+// * Serves /metrics, runs on its own thread while the client is up
+local_server metrics_server;
+
+/**
+ * @brief Starts the local metrics endpoint at http://127.0.0.1:<port>/metrics.
+ *
+ * Serves the Metrics registry in the Prometheus text format, bound to loopback so only
+ * a scraper or agent on the device can read it. Values the program already tracks
+ * (mode, speed, control channel, model, log queue) are registered as callbacks here.
+ * Call metrics_server.run() on a thread afterwards.
+ *
+ * @param port The TCP port.
+ * @return false if the port could not be opened.
+ **/
+bool start_metrics_server(unsigned short port) {
+    metrics.callback("edge_mode", "Operating mode, 0 SAFE, 1 PREDICTION", Metrics::GAUGE,
+                     []() { return current_mode == PREDICTION_MODE ? 1.0 : 0.0; });
+    metrics.callback("edge_speed", "Sampling speed, 0 SLOW, 1 MEDIUM, 2 FAST", Metrics::GAUGE,
+                     []() { return static_cast<double>(current_speed); });
+    metrics.callback("edge_control_channel_up", "1 while control commands arrive over the WebSocket", Metrics::GAUGE,
+                     []() { return control_channel_up ? 1.0 : 0.0; });
+    metrics.callback("edge_model_loaded", "1 while an AI model is loaded", Metrics::GAUGE,
+                     []() { return std::atomic_load(&ai_model) != nullptr ? 1.0 : 0.0; });
+    metrics.callback("edge_log_queue_depth", "Log messages waiting for the writer thread", Metrics::GAUGE,
+                     []() { return static_cast<double>(logManager.queueDepth()); });
+    metrics.callback("edge_log_dropped_total", "Log messages dropped because the log buffer was full", Metrics::COUNTER,
+                     []() { return static_cast<double>(logManager.droppedTotal()); });
+
+    metrics_server.set_error_channels(websocketpp::log::elevel::none);
+    metrics_server.set_access_channels(websocketpp::log::alevel::none);
+    metrics_server.init_asio();
+    metrics_server.set_reuse_addr(true);
+    metrics_server.set_http_handler([](websocketpp::connection_hdl hdl) {
+        local_server::connection_ptr con = metrics_server.get_con_from_hdl(hdl);
+        if (con->get_resource() != "/metrics") {
+            con->set_status(websocketpp::http::status_code::not_found);
+            return;
+        }
+        con->append_header("Content-Type", "text/plain; version=0.0.4");
+        con->set_body(metrics.render());
+        con->set_status(websocketpp::http::status_code::ok);
+    });
+
+    websocketpp::lib::error_code ec;
+    metrics_server.listen("127.0.0.1", std::to_string(port), ec);
+    if (ec) {
+        std::cerr << "Error: Unable to open metrics port " << port << ": " << ec.message() << std::endl;
+        LOG_MSG(ERR, "Unable to open metrics port: " + ec.message());
+        return false;
+    }
+    metrics_server.start_accept(ec);
+    LOG_MSG(INFO, "Metrics served on 127.0.0.1:" + std::to_string(port) + "/metrics");
+    return true;
+}
+
+// * Identity handed out by the stand-in /register endpoint
+const std::string bench_hardware_id = "BENCH-0001";
+// * Speed under test, returned by the stand-in /hardware endpoint and pushed on WebSocket open
+std::atomic<int> bench_speed(SLOW);
+
+// * /hardware body, or with pushed set the same fields as a WebSocket control frame
+std::string bench_control_json(bool pushed) {
+    const char* speeds[] = {"SLOW", "MEDIUM", "FAST"};
+    nlohmann::json control = {
+        {"HardwareID", bench_hardware_id},
+        {"Mode", "PREDICTION"},
+        {"Speed", speeds[bench_speed.load()]}
+    };
+    if (pushed) {
+        control["Type"] = "control";
+    }
+    return control.dump();
+}
+
+/**
+ * @brief Runs the whole client against a local stand-in server and reports pipeline latency.
+ *
+ * One websocketpp server on 127.0.0.1 (BENCH_PORT, 18181 by default) plays both sides:
+ * its HTTP handler answers /register and /hardware, its WebSocket side pushes a control
+ * frame ("Type": "control", see handle_control_message) once on open and reads sensor
+ * frames without replying, as the real server does.
+ * For each of SLOW, MEDIUM and FAST the usual threads (sampling, AI, print, send, machine
+ * handling) run for the given time in PREDICTION mode, then are stopped.
+ *
+ * Reported per speed: p50/p99/p999 latency from update_sensor_data until send() returns,
+ * i.e. the frame is handed to the socket (not wire time, nothing is echoed back), messages
+ * per second, CPU per pipeline thread and whether a model was loaded (without one frames
+ * are forwarded unpredicted). The summary is printed and written to
+ * pipeline_bench_results.json. Nothing leaves the machine.
+ *
+ * @param seconds Run time per speed.
+ * @return The process exit code.
+ **/
+int run_pipeline_bench(int seconds) {
+    unsigned short port = 18181;
+    if (getenv("BENCH_PORT") != nullptr) {
+        port = static_cast<unsigned short>(std::atoi(getenv("BENCH_PORT")));
+    }
+    if (seconds <= 0) {
+        seconds = 30;
+    }
+
+    local_server server;
+    server.set_error_channels(websocketpp::log::elevel::none);
+    server.set_access_channels(websocketpp::log::alevel::none);
+    server.init_asio();
+    server.set_reuse_addr(true);
+    // * REST stand-in, plain HTTP requests on the WebSocket port
+    server.set_http_handler([&server](websocketpp::connection_hdl hdl) {
+        local_server::connection_ptr con = server.get_con_from_hdl(hdl);
+        std::string resource = con->get_resource();
+        if (resource == "/register") {
+            con->set_body(nlohmann::json{{"HardwareID", bench_hardware_id}}.dump());
+        } else if (resource == "/hardware") {
+            con->set_body(bench_control_json(false));
+        } else {
+            con->set_status(websocketpp::http::status_code::not_found);
+            return;
+        }
+        con->append_header("Content-Type", "application/json");
+        con->set_status(websocketpp::http::status_code::ok);
+    });
+    server.set_open_handler([&server](websocketpp::connection_hdl hdl) {
+        websocketpp::lib::error_code ec;
+        server.send(hdl, bench_control_json(true), websocketpp::frame::opcode::text, ec);
+    });
+    // * sensor frames are consumed without a reply, like the real server does
+    server.set_message_handler([](websocketpp::connection_hdl, local_server::message_ptr) {});
+
+    websocketpp::lib::error_code ec;
+    server.listen("127.0.0.1", std::to_string(port), ec);
+    if (ec) {
+        std::cerr << "\033[1;31mBench server cannot listen on port " << port << ": " << ec.message() << "\033[0m" << std::endl;
+        LOG_MSG(ERR, "Bench server cannot listen: " + ec.message());
+        return 1;
+    }
+    server.start_accept();
+    std::thread server_thread([&server]() { server.run(); });
+
+    std::string address = "127.0.0.1:" + std::to_string(port);
+    rest_main_server_cstr = "http://" + address;
+    std::string uri = "ws://" + address;
+
+    int status = 0;
+    nlohmann::json results = nlohmann::json::array();
+    // * whether ai_model was set at the end of every run, i.e. frames were really predicted
+    bool all_models_loaded = true;
+    HTTPResponse reply = http.get_async(rest_main_server_cstr + "/register", http_timeout_ms).get();
+    if (!reply.ok()) {
+        std::cerr << "\033[1;31mBench server did not answer /register\033[0m" << std::endl;
+        status = 1;
+    } else {
+        HardwareID = nlohmann::json::parse(reply.body)["HardwareID"].get<std::string>();
+
+        const speed speeds[] = {SLOW, MEDIUM, FAST};
+        const char* speed_names[] = {"SLOW", "MEDIUM", "FAST"};
+        pipeline_probe.enable(true);
+        for (speed s : speeds) {
+            std::cout << "Pipeline bench: " << speed_names[s] << " for " << seconds << " s" << std::endl;
+            bench_speed = s;
+            current_speed = s;
+            current_mode = PREDICTION_MODE;
+            control_channel_up = false;
+            is_run = true;
+            pipeline_probe.reset();
+
+            client c;
+            std::thread machine_thread(handle_machine);
+            std::thread client_thread(handle_no_secure, uri, &c);
+            std::this_thread::sleep_for(std::chrono::seconds(seconds));
+            pipeline_probe.stop();
+            // * Ai_handle drops the model when it exits, so look while the run is still going
+            bool model_loaded = std::atomic_load(&ai_model) != nullptr;
+            all_models_loaded = all_models_loaded && model_loaded;
+            is_run = false;
+            client_thread.join();
+            machine_thread.join();
+            // * the send thread is detached, it has to be gone before its client is destroyed;
+            // * no bound here, its own wait is bounded by stage_wait_timeout once is_run is false
+            while (send_threads_running > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            // * its CPU report follows right after, a missing one only leaves the row out
+            if (!pipeline_probe.wait_for_thread("send_json_loop", std::chrono::seconds(1))) {
+                LOG_STATIC(WARNING, "Pipeline bench: send thread did not report");
+            }
+
+            nlohmann::json result = pipeline_probe.report();
+            result["speed"] = speed_names[s];
+            result["model_loaded"] = model_loaded;
+            results.push_back(result);
+        }
+        pipeline_probe.enable(false);
+    }
+
+    server.stop_listening(ec);
+    server.stop();
+    server_thread.join();
+    if (status != 0) {
+        return status;
+    }
+
+    std::cout << std::endl << std::left << std::setw(8) << "speed" << std::right
+              << std::setw(10) << "messages" << std::setw(10) << "msg/s"
+              << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "p999 us"
+              << std::setw(12) << "cpu %" << std::endl;
+    std::cout << "(latency: sample until send() returns, socket hand-off only)" << std::endl;
+    for (const nlohmann::json& r : results) {
+        std::cout << std::left << std::setw(8) << r["speed"].get<std::string>() << std::right << std::fixed
+                  << std::setw(10) << r["messages"].get<size_t>()
+                  << std::setw(10) << std::setprecision(2) << r["messages_per_second"].get<double>()
+                  << std::setw(12) << std::setprecision(1) << r["latency_us"]["p50"].get<double>()
+                  << std::setw(12) << r["latency_us"]["p99"].get<double>()
+                  << std::setw(12) << r["latency_us"]["p999"].get<double>()
+                  << std::setw(12) << std::setprecision(2) << r["cpu"]["process"]["percent"].get<double>() << std::endl;
+        for (auto thread = r["cpu"].begin(); thread != r["cpu"].end(); ++thread) {
+            std::cout << "        " << std::left << std::setw(24) << thread.key() << std::right
+                      << std::setw(10) << std::setprecision(1) << thread.value()["ms"].get<double>() << " ms"
+                      << std::setw(10) << std::setprecision(2) << thread.value()["percent"].get<double>() << " %" << std::endl;
+        }
+    }
+
+    nlohmann::json report = {
+        {"seconds_per_speed", seconds},
+        {"model_loaded", all_models_loaded},
+        {"latency_span", "update_sensor_data to send() return"},
+        {"results", results}
+    };
+    std::ofstream out("pipeline_bench_results.json");
+    if (!out) {
+        std::cerr << "\033[1;31mUnable to write pipeline_bench_results.json\033[0m" << std::endl;
+        return 1;
+    }
+    out << report.dump(4) << std::endl;
+    std::cout << "Results written to pipeline_bench_results.json" << std::endl;
+    return 0;
+}
+
 int main(int argc, char *argv[]){
     std::cout << "EdgeFrontier - Sensor Data Simulator" << std::endl;
     std::cout << "Press 't' or 'T' to quit the program." << std::endl;
@@ -869,6 +1464,10 @@ int main(int argc, char *argv[]){
     }
     // * Set the log file for the log manager
     logManager.setLogFile("EdgeFrontier/log/activity.log");
+    // * --bench [seconds] measures the pipeline against a local stand-in server, then exits
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return run_pipeline_bench(argc > 2 ? std::atoi(argv[2]) : 30);
+    }
     // * Load environment variables from a .env file
     std::string envFilePath = "EdgeFrontier/env/dev.env";
     std::unordered_map<std::string, std::string> envMap;
@@ -882,22 +1481,20 @@ int main(int argc, char *argv[]){
         rest_main_server_cstr = getenv("REST_MAIN_SERVER");
         if (rest_main_server_cstr.empty()) {
             std::cerr << "Error: REST_MAIN_SERVER environment variable is not set." << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "REST_MAIN_SERVER environment variable is not set.");
+            LOG_STATIC(ERR, "REST_MAIN_SERVER environment variable is not set.");
             return 1;
         }
         // TODO I recommend to remove this "\t\n\r\f\v" at the end of the string
         rest_main_server_cstr.erase(rest_main_server_cstr.find_last_not_of("\t\n\r\f\v") + 1);
 
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "REST_MAIN_SERVER environment variable is set.");
+        LOG_STATIC(DEBUG, "REST_MAIN_SERVER environment variable is set.");
 
         std::cout << "REST_MAIN_SERVER: " << rest_main_server_cstr << std::endl;
-        response = http.get(rest_main_server_cstr + "/register");
+        HTTPResponse reply = http.get_async(rest_main_server_cstr + "/register", http_timeout_ms).get();
+        response = reply.ok() ? reply.body : "";
         if (response == "") {
             std::cerr << "Error: Unable to connect to the main server." << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "Unable to connect to the main server.");
+            LOG_STATIC(ERR, "Unable to connect to the main server.");
             std::this_thread::sleep_for(std::chrono::microseconds(200000));
         }
 
@@ -907,91 +1504,127 @@ int main(int argc, char *argv[]){
                 HardwareID = pre_info["HardwareID"].get<std::string>();
                 std::transform(HardwareID.begin(), HardwareID.end(), HardwareID.begin(), ::toupper);
                 std::cout << "HardwareID: " << HardwareID << std::endl;
-                logManager.setLogLevel(LogManager::INFO);
-                logManager.log(LogManager::INFO, "HardwareID is set.");
+                LOG_STATIC(INFO, "HardwareID is set.");
             }
         } else {
             std::cerr << "Error: HardwareID is not set." << std::endl;
-            logManager.setLogLevel(LogManager::ERR);
-            logManager.log(LogManager::ERR, "HardwareID is not set.");
+            LOG_STATIC(ERR, "HardwareID is not set.");
         }
     }
 
     // ! if rest api is http log warning
     if (rest_main_server_cstr.find("https") == std::string::npos) {
-        logManager.setLogLevel(LogManager::WARNING);
-        logManager.log(LogManager::WARNING, "REST API is not secure");
+        LOG_STATIC(WARNING, "REST API is not secure");
     } else {
-        logManager.setLogLevel(LogManager::DEBUG);
-        logManager.log(LogManager::DEBUG, "REST API is secure");
+        LOG_STATIC(DEBUG, "REST API is secure");
     }
 
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Environment variables loaded from .env file.");
+    // * LOG_LEVEL (DEBUG, INFO, WARNING, ERROR) sets the log threshold, INFO by default
+    const char* log_level_env = getenv("LOG_LEVEL");
+    if (log_level_env != nullptr) {
+        LogManager::LogLevel level;
+        if (LogManager::parseLogLevel(log_level_env, level)) {
+            logManager.setLogLevel(level);
+        } else {
+            LOG_MSG(WARNING, "Unknown LOG_LEVEL: " + std::string(log_level_env));
+        }
+    }
+    // * LOG_FORMAT=binary writes a compact binary log instead, render it with Tools/log_decode
+    const char* log_format_env = getenv("LOG_FORMAT");
+    if (log_format_env != nullptr && std::string(log_format_env) == "binary") {
+        logManager.setLogFile("EdgeFrontier/log/activity.log.bin", LogManager::BINARY);
+    }
+    // * rotate the log file so long-running units do not fill their storage
+    // * LOG_MAX_BYTES / LOG_MAX_AGE_HOURS / LOG_MAX_TOTAL_BYTES / LOG_COMPRESS override the defaults
+    LogManager::RotationPolicy rotation;
+    rotation.maxFileBytes = 10 * 1024 * 1024;
+    rotation.maxFileAge = std::chrono::hours(24);
+    rotation.compress = true;
+    rotation.maxTotalBytes = 50 * 1024 * 1024;
+    if (getenv("LOG_MAX_BYTES") != nullptr) {
+        rotation.maxFileBytes = std::strtoull(getenv("LOG_MAX_BYTES"), nullptr, 10);
+    }
+    if (getenv("LOG_MAX_AGE_HOURS") != nullptr) {
+        rotation.maxFileAge = std::chrono::hours(std::strtoull(getenv("LOG_MAX_AGE_HOURS"), nullptr, 10));
+    }
+    if (getenv("LOG_MAX_TOTAL_BYTES") != nullptr) {
+        rotation.maxTotalBytes = std::strtoull(getenv("LOG_MAX_TOTAL_BYTES"), nullptr, 10);
+    }
+    if (getenv("LOG_COMPRESS") != nullptr) {
+        rotation.compress = std::string(getenv("LOG_COMPRESS")) != "0";
+    }
+    logManager.setRotation(rotation);
+    LOG_STATIC(DEBUG, "Environment variables loaded from .env file.");
 
     // * Check if the WS_URI environment variable is set
     std::string ws_uri_cstr = envMap["WS_URI"];
     if (ws_uri_cstr.empty()) {
         std::cerr << "Error: WS_URI environment variable is not set." << std::endl;
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "WS_URI environment variable is not set.");
+        LOG_STATIC(ERR, "WS_URI environment variable is not set.");
         return 1;
     }
     // TODO I recommend to remove this "\t\n\r\f\v" at the end of the string
     ws_uri_cstr.erase(ws_uri_cstr.find_last_not_of("\t\n\r\f\v") + 1);
 
     std::string uri(ws_uri_cstr);
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "WS_URI environment variable is set.");
+    LOG_STATIC(DEBUG, "WS_URI environment variable is set.");
 
     std::cout << "WS_URI: " << uri << std::endl;
 
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Connecting to WebSocket server");
+    LOG_STATIC(DEBUG, "Connecting to WebSocket server");
 
     std::cout << "Connecting to WebSocket server at: " << uri << std::endl;
     client c;
     tls_client tc;
-    logManager.setLogLevel(LogManager::INFO);
-    logManager.log(LogManager::INFO, "WebSocket client initialized.");
+    LOG_STATIC(INFO, "WebSocket client initialized.");
     
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Checking if WebSocket connection is secure.");
+    LOG_STATIC(DEBUG, "Checking if WebSocket connection is secure.");
+
+    // * METRICS_PORT serves /metrics on loopback for a local scraper, 9464 by default, 0 disables
+    unsigned short metrics_port = 9464;
+    if (getenv("METRICS_PORT") != nullptr) {
+        metrics_port = static_cast<unsigned short>(std::atoi(getenv("METRICS_PORT")));
+    }
+    std::thread metrics_thread;
+    if (metrics_port != 0 && start_metrics_server(metrics_port)) {
+        metrics_thread = std::thread([]() { metrics_server.run(); });
+    }
 
     std::thread machine_thread(handle_machine);
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Starting machine handle thread");
+    LOG_STATIC(DEBUG, "Starting machine handle thread");
 
     // * is_run thread for checking input
     std::thread input_thread(checkInput_main);
-    logManager.setLogLevel(LogManager::DEBUG);
-    logManager.log(LogManager::DEBUG, "Starting input checking thread");
+    LOG_STATIC(DEBUG, "Starting input checking thread");
 
     // * Check if the WebSocket connection is secure
     is_secure(uri) ? handle_secure(ws_uri_cstr, &tc) : handle_no_secure(ws_uri_cstr, &c);
 
     std::cout << "Exiting main thread" << std::endl;
-    logManager.setLogLevel(LogManager::INFO);
-    logManager.log(LogManager::INFO, "Exiting main thread");
+    LOG_STATIC(INFO, "Exiting main thread");
 
     // * Wait for the input thread to finish
     if (input_thread.joinable()) {
         input_thread.join();
-        logManager.setLogLevel(LogManager::INFO);
-        logManager.log(LogManager::INFO, "Input checking thread joined");
+        LOG_STATIC(INFO, "Input checking thread joined");
     } else {
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "Input checking thread is not joinable");
+        LOG_STATIC(ERR, "Input checking thread is not joinable");
     }
     
     // * Wait for the machine handle thread to finish
     if (machine_thread.joinable()) {
         machine_thread.join();
-        logManager.setLogLevel(LogManager::INFO);
-        logManager.log(LogManager::INFO, "Machine handle thread joined");
+        LOG_STATIC(INFO, "Machine handle thread joined");
     } else {
-        logManager.setLogLevel(LogManager::ERR);
-        logManager.log(LogManager::ERR, "Machine handle thread is not joinable");
+        LOG_STATIC(ERR, "Machine handle thread is not joinable");
+    }
+
+    if (metrics_thread.joinable()) {
+        websocketpp::lib::error_code ec;
+        metrics_server.stop_listening(ec);
+        metrics_server.stop();
+        metrics_thread.join();
+        LOG_STATIC(INFO, "Metrics thread joined");
     }
     
     return 0;